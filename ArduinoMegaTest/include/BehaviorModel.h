@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+
+// Behavioral models for the IC_DB entries with model != MODEL_NONE.
+//
+// A model sees the word the tester drives (inputs and clocks, bit i = socket
+// pin i+1). evaluate gives the outputs it expects for that word; step is
+// called after every change of the driven word and applies clock edges and
+// asynchronous clears to the model state. Combinational models ignore state.
+
+struct ModelState {
+  uint8_t q;          // register bits (194: Q0..Q3, 7473: Q1, Q2)
+};
+
+void     modelReset(ModelState &st);
+uint16_t modelEvaluate(const ICProfile &ic, const ModelState &st, uint16_t word);
+void     modelStep(const ICProfile &ic, ModelState &st, uint16_t prev, uint16_t word);
+
+// Gate netlist plus model: everything the verifier can predict for a word.
+uint16_t expectedOutputs(const ICProfile &ic, const ModelState &st, uint16_t word);
+uint16_t checkedOutputMask(const ICProfile &ic);
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// The eight front-panel buttons (pins 2-9, active low with pull-ups).
+//
+// Pins 2-9 sit on PORTE/PORTG/PORTH, none of which has pin-change
+// interrupts, so Timer4 samples all eight at BUTTON_TICK_HZ instead and
+// debounces each one on its own: a button changes state once its pin has
+// read the new level for BUTTON_STABLE_MS ticks in a row, whatever the
+// others are doing. Every change is queued with the tick it settled on; the
+// main loop drains the queue in order with buttonRead(), so presses that
+// arrive while it is busy (a clock pulse, a sweep) are handled late rather
+// than lost, and buttonTicks() tells how late.
+//
+// Off-target buttonService() runs the ticks that fell due since its last
+// call and the pins are read through digitalRead().
+
+#define BUTTON_COUNT     8
+#define BUTTON_TICK_HZ   1000UL
+#define BUTTON_STABLE_MS 8
+#define BUTTON_EVENTS    16          // power of two
+
+struct ButtonEvent {
+  uint8_t  button;                   // 0-7
+  bool     pressed;
+  uint32_t ms;                       // tick the new level settled on
+};
+
+void     buttonsBegin();
+bool     buttonRead(ButtonEvent &e);  // oldest queued change, false if none
+bool     buttonDown(uint8_t button);  // debounced level
+uint16_t buttonEventsLost();         // changes dropped on a full queue
+uint32_t buttonTicks();              // ticks (ms) since buttonsBegin()
+void     buttonService();
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+// Logic analyzer: Timer3 samples the 16 pins of one socket at a fixed rate into a
+// RAM ring. Sampling runs until the trigger pattern becomes true (a masked
+// compare against the pin word, mask 0 triggers at once), keeps up to `pre`
+// samples from before it and fills the rest of the ring after it. The
+// finished record is read back in order with captureRead().
+//
+// Any rate from 1 Hz to CAPTURE_MAX_HZ is accepted: captureStart() picks the
+// smallest Timer3 prescaler (1/8/64/256/1024) that keeps the compare value
+// within 16 bits, so slow rates are not cut short by a wrapped OCR3A.
+//
+// Off-target captureService() runs the samples that fell due since its last
+// call, as ClockGen does for its ticks.
+
+#define CAPTURE_DEPTH  1024          // samples, power of two
+#define CAPTURE_MAX_HZ 50000UL       // ISR budget at 16 MHz, leaves room for ClockGen
+
+enum CaptureState : uint8_t { CAP_IDLE, CAP_ARMED, CAP_TRIGGERED, CAP_DONE };
+
+void         captureBegin();
+bool         captureStart(uint8_t bank, uint32_t hz, uint16_t pre, uint16_t mask, uint16_t value);
+void         captureStop();              // ends an armed or running capture now
+CaptureState captureState();
+uint16_t     captureLength();            // samples in the finished record
+uint16_t     captureTriggerIndex();      // index of the trigger sample in it
+uint32_t     captureRate();
+bool         captureRead(uint16_t &word); // next sample of the record, false at end
+void         captureRelease();           // record consumed, back to idle
+void         captureService();
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+
+// Timer-driven clock engine for the sockets' clock pins.
+//
+// Timer1 interrupts at CLOCK_TICK_HZ while any channel runs (the compare
+// interrupt is off otherwise, so an idle clock costs no ISR time). Each channel is a phase accumulator
+// that toggles its pin whenever it wraps, so any frequency up to
+// CLOCK_TICK_HZ/2 is produced exactly on average (edges jitter by at most one
+// tick). A channel runs free or stops after a burst of N edges, may start
+// with a phase delay relative to the others, and can latch the whole pin
+// word of its socket right after its rising or falling edges into a sample
+// ring the main loop drains with clockReadSample(). Channels belong to pin
+// banks (sockets); start and stop take a channel mask so one socket's clocks
+// can run while another's are reconfigured.
+//
+// Off-target there is no Timer1; clockService() runs the ticks that fell due
+// since its last call, so native builds see the same edges in virtual time.
+
+#define CLOCK_CHANNELS 4
+#define CLOCK_TICK_HZ  20000UL
+#define CLOCK_MAX_HZ   (CLOCK_TICK_HZ/2)
+#define CLOCK_SAMPLES  32           // power of two
+
+enum ClockEdge : uint8_t { EDGE_NONE, EDGE_RISING, EDGE_FALLING };
+
+void    clockBegin();
+void    clockReset();                                   // stop and detach all channels
+int8_t  clockAttach(uint8_t bank, uint8_t pin);         // socket bit -> channel, -1 if full
+uint8_t clockChannels();
+uint8_t clockChannelPin(uint8_t ch);
+uint8_t clockChannelBank(uint8_t ch);
+
+// Arms a channel: hz in (0, CLOCK_MAX_HZ], edges 0 = free running, phase in
+// degrees of its own period. Nothing moves until clockStart(), which replays
+// the whole configuration (burst and phase delay included) every time.
+bool    clockConfigure(uint8_t ch, float hz, uint32_t edges, uint16_t phaseDeg);
+void    clockSampleOn(uint8_t ch, ClockEdge edge);
+void    clockStart(uint8_t chMask = 0xFF);              // armed channels in chMask, same tick
+// One full pulse (two edges) at hz on the channels in chMask, started like
+// clockStart() but leaving their configuration for the next clockStart().
+bool    clockPulse(uint8_t chMask, float hz);
+void    clockStop(uint8_t chMask = 0xFF);               // pins are left low
+bool    clockBusy(uint8_t chMask = 0xFF);               // any of them still running
+uint32_t clockEdgeCount(uint8_t ch);
+
+bool    clockReadSample(uint16_t &word);
+uint16_t clockSamplesLost();
+
+void    clockService();
@@ -0,0 +1,100 @@
+#pragma once
+#include <stdint.h>
+#include <ICLibrary.h>
+
+const uint8_t TOTAL_PINS = 16;
+
+// Gate types
+enum GateType : uint8_t { AND, OR, NAND, NOR, XOR, XNOR, NOT };
+
+// Behavioral models for parts that are not a bank of simple gates
+// (see BehaviorModel.h).
+enum ModelType : uint8_t {
+  MODEL_NONE,
+  MODEL_SHIFT_194,    // 4-bit bidirectional universal shift register
+  MODEL_CMP_7485,     // 4-bit magnitude comparator with cascade inputs
+  MODEL_JK_7473,      // dual JK flip-flop with clear
+  MODEL_DEC_74139,    // dual 2-to-4 decoder, active-low
+  MODEL_MUX_74157     // quad 2-to-1 multiplexer
+};
+
+// Pin roles; the values double as the characters of a profile's layout string.
+enum PinRole : char {
+  ROLE_NC     = 'N',
+  ROLE_VCC    = 'V',
+  ROLE_GND    = 'G',
+  ROLE_INPUT  = 'I',   // driven by the tester
+  ROLE_OUTPUT = 'O',   // sampled by the tester
+  ROLE_CLOCK  = 'C'    // driven by the tester's clock
+};
+
+// Structures
+struct LogicGate {
+  GateType type;
+  uint8_t  inputs[4];
+  uint8_t  inputCount;
+  uint8_t  output;
+};
+
+// Profiles live in flash (PROGMEM); pin words use bit i for socket pin i+1.
+// All role information is folded into masks at compile time.
+struct ICProfile {
+  char      name[IC_NAME_LEN];
+  uint16_t  inputMask;
+  uint16_t  outputMask;
+  uint16_t  vccMask;
+  uint16_t  gndMask;
+  uint16_t  ncMask;
+  uint16_t  clockMask;
+  uint16_t  activeMask;   // everything but NC
+  uint8_t   activePins;
+  LogicGate gates[8];
+  uint8_t   gateCount;
+  ModelType model;
+};
+
+constexpr uint16_t roleMask(const char *layout, char role, uint8_t i = 0) {
+  return i == TOTAL_PINS ? 0
+       : (uint16_t)((layout[i] == role ? 1u << i : 0) | roleMask(layout, role, i + 1));
+}
+
+constexpr uint8_t roleCount(const char *layout, char role, uint8_t i = 0) {
+  return i == TOTAL_PINS ? 0 : (layout[i] == role) + roleCount(layout, role, i + 1);
+}
+
+// IC_PROFILE("7400", "IIOIIOGNNOIIOIIV", {gates...}, gateCount[, model])
+// The table itself (src/ICTable.gen.cpp) is generated at build time from the
+// front end's JSON part library by SharedLib/ICLibrary/icgen.py.
+#define IC_PROFILE(name, layout, ...) {                                        \
+    name,                                                                      \
+    roleMask(layout, ROLE_INPUT), roleMask(layout, ROLE_OUTPUT),               \
+    roleMask(layout, ROLE_VCC),   roleMask(layout, ROLE_GND),                  \
+    roleMask(layout, ROLE_NC),    roleMask(layout, ROLE_CLOCK),                \
+    (uint16_t)~roleMask(layout, ROLE_NC),                                      \
+    (uint8_t)(TOTAL_PINS - roleCount(layout, ROLE_NC)),                        \
+    __VA_ARGS__ }
+
+// Structural test set of a gate part: the fewest input words found that
+// detect every detectable single stuck-at fault of its netlist, worked out
+// by SharedLib/ICLibrary/faultsim.py when the table is generated.
+struct ICTestSet {
+  uint16_t first;     // into IC_TEST_WORDS
+  uint8_t  count;     // 0 for parts without gates
+};
+
+extern const ICProfile IC_DB[];
+extern const uint8_t IC_DB_COUNT;
+extern const uint16_t IC_TEST_WORDS[];
+extern const ICTestSet IC_TEST_SETS[];   // one per IC_DB entry
+
+// Flash access
+void    loadProfile(uint8_t index, ICProfile &out);
+void    loadTestSet(uint8_t index, ICTestSet &out);
+int8_t  findProfile(const char *name);   // any name of the part, -1 if unknown
+PinRole pinRole(const ICProfile &ic, uint8_t pin);
+
+// Gate netlist helpers
+bool     evaluateGate(const LogicGate &g, uint16_t word);
+uint16_t gateOutputs(const ICProfile &ic, uint16_t word);
+uint16_t gateInputMask(const ICProfile &ic);
+uint16_t gateOutputMask(const ICProfile &ic);
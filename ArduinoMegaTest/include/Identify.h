@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+
+// Identification of an unmarked part among IC_DB profiles that share a
+// reference profile's pinout (same VCC/GND/input/output pins), e.g. the
+// quad 2-input gates 7400/7408/7432/7486. It walks a decision tree built
+// on the fly: each step applies the input vector whose predicted outputs
+// split the remaining candidates best (smallest largest group), then keeps
+// the candidates that predicted what was read back.
+//
+// The socket on pin bank `bank` must already be configured for the
+// reference pinout.
+
+#define IDENTIFY_MAX_STEPS 8
+#define IDENTIFY_SETTLE_US 5
+#define IDENTIFY_MAX_PARTS 32   // candidates are a 32-bit set; the generated
+                                // table lists gate parts first
+
+struct IdentifyResult {
+  int8_t   index;       // IC_DB index, -1 if none or several remain
+  uint32_t remaining;   // bit i = IC_DB[i] still consistent
+  uint8_t  vectors;     // vectors applied
+};
+
+// Candidates sharing ref's pinout and having a gate netlist.
+uint32_t identifyCandidates(const ICProfile &ref);
+void     identifyPart(const ICProfile &ref, uint8_t bank, IdentifyResult &r);
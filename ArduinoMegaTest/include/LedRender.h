@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+// Output indicators on the three WS2812 strips.
+//
+// ledMap() gives every output pin of the selected part an LED, in socket pin
+// order (gate outputs, decoder lines and counter bits alike); LEDs beyond the
+// outputs stay dark. ledUpdate() colours them from a pin word (green high,
+// red low) and marks the strips whose colours actually changed.
+//
+// WS2812 output runs with interrupts off, so ledService() writes dirty strips
+// one at a time - three LEDs take ~90 us, less than the two bytes the AVR
+// USART holds in hardware at 115200 baud - and only once the UARTs have been
+// quiet for LED_QUIET_MS. Nothing is written while the colours stand still.
+
+#define LED_STRIPS      3
+#define LEDS_PER_STRIP  3
+#define LED_COUNT       (LED_STRIPS*LEDS_PER_STRIP)
+#define LED_PIN_STRIP1  10
+#define LED_PIN_STRIP2  11
+#define LED_PIN_STRIP3  12
+#define LED_QUIET_MS    2
+
+void    ledBegin();
+void    ledMap(uint16_t outputMask);          // bit i = socket pin i+1, 0 = all dark
+void    ledUpdate(uint16_t word);
+// rxActivity: any count that moves when a UART receives a byte.
+void    ledService(uint32_t rxActivity);
+
+extern uint16_t ledFrames;      // strip writes done
+extern uint16_t ledDeferrals;   // times changed colours had to wait for a quiet link
@@ -0,0 +1,51 @@
+#pragma once
+#include <Arduino.h>
+#include <DisplayCache.h>
+#include <Telemetry.h>
+
+// Non-blocking link to the Nextion display on Serial3.
+//
+// Commands are queued and pumped out by nextionService() only as fast as the
+// UART TX buffer has room, so the loop never waits on the 9600 baud wire.
+// A queued state write that has not started transmitting is replaced in
+// place by a newer one for the same target ("PINS:", "t0.txt=", ...), so the
+// display always catches up with the latest state instead of replaying stale
+// ones. Events are never merged.
+//
+// nextionShow() is for component state: it goes through a DisplayCache and
+// is dropped when the display already shows that value. nextionQueue() is
+// for events and always sends.
+//
+// nextionBegin() moves the link off the display's 9600 baud power-on rate:
+// it sends "baud=<target>", follows at the new rate and checks that the
+// display answers "sendme"; if it does not, both sides go back to 9600.
+
+#define NEXTION_SERIAL   Serial3
+#define NEXTION_SLOTS    8
+#define NEXTION_CMD_MAX  64
+#define NEXTION_RX_MAX   64
+#define NEXTION_RX_IDLE_MS 20   // a line without terminator ends after this much silence
+#define NEXTION_BAUD_DEFAULT 9600    // what a freshly powered display listens at
+#ifndef NEXTION_TARGET_BAUD
+#define NEXTION_TARGET_BAUD 115200
+#endif
+#define NEXTION_PROBE_MS 100         // wait for the "sendme" reply
+#define NEXTION_SWITCH_MS 20         // let the display apply baud= before probing
+#define NEXTION_REFRESH_MS 10000     // resend state this often in case the display was reset
+
+// Returns the verified baud rate, or 0 if no display answered (the link is
+// then left at NEXTION_BAUD_DEFAULT). Blocks for up to ~5 probe timeouts.
+unsigned long nextionBegin(unsigned long target);
+unsigned long nextionBaud();
+bool    nextionValidBaud(unsigned long baud);
+void    nextionQueue(const String &cmd);
+bool    nextionShow(const String &cmd);
+void    nextionInvalidate();   // forget what the display shows; next writes all go out
+void    nextionService();
+bool    nextionReadLine(String &line);
+uint8_t nextionPending();
+
+extern uint16_t nextionDropped;     // commands lost to a full queue or over-length
+extern uint16_t nextionCoalesced;   // stale commands replaced before sending
+extern DisplayCache nextionCache;   // .suppressed counts writes that changed nothing
+extern LinkCounters nextionLink;    // bytes/commands sent, bytes/lines received
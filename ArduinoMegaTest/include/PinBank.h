@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+
+// Port-level access to the IC socket pins, one bank of 16 per socket.
+//
+// A pin word carries one bit per socket pin: bit i is socket pin i+1. On the
+// Mega socket 0 (bank 0) is wired to
+//   pins 22,24,26,28  -> PA0,PA2,PA4,PA6   (bits 0-3)
+//   pins 30..37       -> PC7..PC0          (bits 4-11)
+//   pin  38           -> PD7               (bit 12)
+//   pins 39,40,41     -> PG2,PG1,PG0       (bits 13-15)
+// and socket 1 (bank 1) to the analog header, which the tester only uses as
+// GPIO:
+//   pins A0..A7       -> PF0..PF7          (bits 0-7)
+//   pins A8..A15      -> PK0..PK7          (bits 8-15)
+// so a whole word is applied or sampled with one access per port. Writes are
+// done with interrupts off so the DUT never sees a half-applied vector.
+//
+// Off-target (no __AVR__) the ports are backed by RAM registers; the mock
+// hooks below let host code play the part of the DUTs.
+
+#ifndef PIN_BANKS
+#define PIN_BANKS 2             // 1 (socket 0 only) or 2
+#endif
+const uint8_t PIN_BANK_SIZE = 16;
+
+void     pinBankBegin();                                 // all pins of all banks floating inputs
+void     pinBankSetDirection(uint8_t bank, uint16_t outputMask);  // 1 = driven by the tester
+uint16_t pinBankDirection(uint8_t bank);
+void     pinBankWrite(uint8_t bank, uint16_t word, uint16_t mask = 0xFFFF);
+void     pinBankToggle(uint8_t bank, uint16_t mask);
+uint16_t pinBankLatch(uint8_t bank);                     // last driven levels
+uint16_t pinBankRead(uint8_t bank);                      // snapshot of all 16 pins
+
+// Toggles toggleMask and counts timer cycles (Timer5 at clk/1, interrupts
+// off) until socket pin watchPin leaves the level it had before the toggle.
+// Returns PIN_BANK_TIMEOUT if it never does. Off-target the pin is polled in
+// virtual time at 1 us resolution.
+const uint16_t PIN_BANK_TIMEOUT = 1600;                  // 100 us at 16 MHz
+uint16_t pinBankTimeEdge(uint8_t bank, uint16_t toggleMask, uint8_t watchPin);
+
+#ifndef __AVR__
+// Levels the (simulated) DUT presents on pins the tester is not driving.
+void     mockPinBankSetExternal(uint8_t bank, uint16_t word);
+uint16_t mockPinBankExternal(uint8_t bank);
+// Raw PORTx / DDRx of port 'A', 'C', 'D', 'G', 'F' or 'K' (0 for others).
+uint8_t  mockPinBankPort(char port);
+uint8_t  mockPinBankDdr(char port);
+// Called after every direction change or write so a simulated DUT can react,
+// and before every read so it can bring delayed outputs up to date.
+extern void (*mockPinBankHook)(uint8_t bank);
+extern void (*mockPinBankSampleHook)(uint8_t bank);
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "Socket.h"
+#include "Sweep.h"
+#include "Vectors.h"
+
+// Runs a test job on several sockets at once. Jobs are resumable (see
+// SweepJob, VecJob): every pass of the scheduler visits each busy socket,
+// checks the state it applied there on the previous pass and applies the
+// next one. The settle time one socket needs is spent applying and checking
+// the others, so it is only waited for when a socket comes round again too
+// early - with a single socket the run behaves like runSweep()/vecRun().
+
+enum JobKind : uint8_t { JOB_SWEEP, JOB_VECTORS };
+
+struct SchedSlot {
+  Socket       *socket;
+  bool          ok;                  // the job could start on this socket
+  unsigned long us;                  // start of the run to its last check
+  SweepJob      sweep;               // JOB_SWEEP
+  SweepResult   result;
+  VecJob        vec;                 // JOB_VECTORS
+  uint8_t       passMap[VEC_MAX/8];
+};
+
+// Runs kind on the n slots until all are done; returns the time spent
+// waiting for settles, in microseconds.
+unsigned long schedRun(JobKind kind, SchedSlot *slots, uint8_t n);
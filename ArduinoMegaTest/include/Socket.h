@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+#include "PinBank.h"
+
+// One DUT position: the part loaded into it, the pin bank it is wired to, the
+// ClockGen channels of its clock pins and the button mapping of its inputs.
+// There is one socket per pin bank. Interactive commands act on the selected
+// socket (SOCKET:<n>); the scheduler runs jobs on every loaded one.
+
+#define SOCKET_COUNT PIN_BANKS
+
+struct Socket {
+  uint8_t   bank;
+  bool      loaded;
+  ICProfile ic;
+  uint8_t   inputPins[8];        // button i toggles socket bit inputPins[i]
+  uint8_t   inputCount;
+  uint8_t   clockFirst;          // ClockGen channels of the clock pins,
+  uint8_t   clockCount;          // in socket pin order
+};
+
+extern Socket sockets[SOCKET_COUNT];
+
+void    socketsBegin();
+// Powers the socket for its part: NC and OUTPUT float, VCC is driven high,
+// everything else starts low. Clock channels of all sockets are rebuilt,
+// which stops any clock that was running.
+void    socketConfigure(Socket &s);
+uint8_t socketClockMask(const Socket &s); // ClockGen channel mask
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include "BehaviorModel.h"
+#include "ICDatabase.h"
+
+// On-device exhaustive truth-table sweep. Every combination of the input pins
+// is applied in Gray-code order (one pin toggles per step) and the sampled
+// outputs are checked against the LogicGate netlist or the part's behavioral
+// model. Clocked parts get a full clock pulse after every vector, checked on
+// both edges, so each register operation is exercised from many states.
+//
+// Gate parts can run their structural test set instead (ICDatabase.h): the
+// same checks over the handful of vectors that already detect every single
+// stuck-at fault, e.g. 3 instead of 256 for a 7400.
+
+#define SWEEP_SETTLE_US 5   // wait between applying a vector and sampling
+#define SWEEP_LOG_SIZE  8   // failing vectors kept for the report
+
+struct SweepFailure {
+  uint16_t input;     // applied pin word (inputs and clocks)
+  uint16_t expected;  // expected outputs
+  uint16_t actual;    // sampled outputs
+};
+
+struct SweepResult {
+  uint32_t     vectors;
+  uint32_t     failures;
+  uint8_t      gateFailMask;   // bit g set if gates[g] ever mismatched (gate parts)
+  uint8_t      logged;
+  SweepFailure log[SWEEP_LOG_SIZE];
+};
+
+// A sweep as a resumable job, for the scheduler: sweepApply() drives the
+// next state (an input vector or a clock level) and sweepCheck() samples and
+// compares it once it has settled. The job keeps the state of the model.
+struct SweepJob {
+  const ICProfile *ic;
+  uint8_t    bank;
+  uint8_t    phase;        // what the last sweepApply() drove
+  uint16_t   inMask, clkMask, outMask;
+  uint16_t   word;         // driven inputs, clocks low
+  uint16_t   applied;      // what is on the pins, clock level included
+  uint16_t   expected;
+  const uint16_t *tests;   // test set words in flash, null for the exhaustive sweep
+  uint8_t    order[TOTAL_PINS];
+  uint32_t   step, total;
+  ModelState st;
+};
+
+// Sets up a sweep of the socket on pin bank `bank`. drivenMask is the set of
+// pins the tester is driving as DUT inputs; returns false if the part needs
+// a pin outside it (or has neither gates nor a model).
+bool sweepBegin(SweepJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+                SweepResult &r);
+// Same for the part's structural test set; also false if it has none.
+bool testBegin(SweepJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+               SweepResult &r);
+bool sweepApply(SweepJob &j);                     // false once the sweep is complete
+void sweepCheck(SweepJob &j, SweepResult &r);
+
+// Whole sweep of one socket, waiting SWEEP_SETTLE_US before every check.
+bool runSweep(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, SweepResult &r);
+bool runTestSet(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, SweepResult &r);
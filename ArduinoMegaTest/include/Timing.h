@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+
+// Propagation delay measurement. For each LogicGate the sweep finds an input
+// whose toggle flips the output with the other inputs held, then times the
+// output edge against that toggle with pinBankTimeEdge(), alternating rising
+// and falling outputs. The same toggle timed against the input pin itself
+// gives the fixed instrumentation latency, which is subtracted.
+//
+// Resolution is one poll of the output port, about 5 cycles (~0.3 us at
+// 16 MHz): healthy TTL reads as 0-1 poll, slow or marginal parts stand out.
+
+#define TIMING_REPS 64
+
+struct GateTiming {
+  uint16_t minNs, avgNs, maxNs;
+  uint16_t timeouts;          // output never moved within PIN_BANK_TIMEOUT
+  uint8_t  input;             // socket pin toggled (1-based)
+};
+
+// Measures every gate of ic in the socket on pin bank `bank`; returns false
+// if it has none or needs a pin outside drivenMask. Inputs are restored
+// afterwards by the caller.
+bool measureTiming(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, uint16_t reps,
+                   GateTiming *out);
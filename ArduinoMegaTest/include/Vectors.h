@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+
+// Host-defined test programs. Vectors are uploaded into a fixed RAM table and
+// run back-to-back at GPIO speed: apply the input word, pulse the clock pins
+// `clocks` times (each pulse toggles them away from the level in the input
+// word and back), settle, and compare the outputs outside the don't-care
+// mask. The result is one pass bit per vector.
+
+#define VEC_MAX       128
+#define VEC_SETTLE_US 5
+
+struct TestVector {
+  uint16_t input;      // socket word; input and clock pins
+  uint16_t expect;     // expected levels of the output pins
+  uint16_t dontCare;   // output pins not checked
+  uint8_t  clocks;     // clock pulses after applying input
+};
+
+void     vecClear(uint8_t keep = 0);             // drop all vectors after the first keep
+bool     vecAdd(const TestVector &v);          // false when the table is full
+uint8_t  vecCount();
+
+// A table run as a resumable job, for the scheduler: vecApply() applies the
+// next vector and its clock pulses, vecCheck() compares it once settled.
+struct VecJob {
+  const ICProfile *ic;
+  uint8_t  bank;
+  uint8_t  next;         // vector vecApply() applies next
+  uint8_t  passed;
+  uint16_t apply;        // driven pins: inputs and clocks
+  uint8_t *passMap;
+};
+
+void     vecBegin(VecJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+                  uint8_t *passMap);
+bool     vecApply(VecJob &j);                  // false once every vector has run
+void     vecCheck(VecJob &j);
+
+// Runs the table on the socket on pin bank `bank`; passMap gets bit i of
+// byte i/8 set for each passing vector. Returns the number of passes.
+uint8_t  vecRun(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, uint8_t *passMap);
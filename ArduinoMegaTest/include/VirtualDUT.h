@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include "ICDatabase.h"
+
+// Virtual chips behind the mock pin banks, for native builds only.
+//
+// A virtual DUT sits in a socket (pin bank) and answers the tester the way
+// the real part would: it sees the pins the tester drives (undriven inputs
+// float high, as TTL inputs do), runs them through the profile's gate
+// netlist and behavioral model, and presents the outputs on the pins after
+// a propagation delay in virtual time. Everything runs on the MockHAL
+// clock, so a full sweep costs host microseconds whatever it would take on
+// the bench.
+//
+// One fault can be injected per socket:
+//   stuck-at-0/1  the pin is held low/high, as the chip sees it and as the
+//                 tester reads it
+//   bridge        two pins shorted, both read the AND of the two (TTL lows win)
+//   open          the pin is not bonded: an input floats high inside the
+//                 chip, an output is never driven and reads low
+// vdutFaultList() enumerates every single fault of a part so a campaign can
+// run the verification paths against each one. An exhaustive sweep catches
+// all of them but one kind: a bridge between two inputs of the same AND or
+// NAND gate (7400/7408 pins 1:2, 4:5, ...) ANDs them just as the gate does,
+// so no input word can tell it from a good chip.
+
+#if !defined(__AVR__)
+
+enum FaultKind : uint8_t { FAULT_NONE, FAULT_STUCK0, FAULT_STUCK1, FAULT_BRIDGE, FAULT_OPEN };
+
+struct Fault {
+  FaultKind kind;
+  uint8_t   pin;       // socket bit
+  uint8_t   other;     // second pin of a bridge
+};
+
+void        vdutInsert(uint8_t bank, const ICProfile &ic);
+void        vdutRemove(uint8_t bank);
+bool        vdutPresent(uint8_t bank);
+void        vdutSetDelay(uint8_t bank, uint32_t ns);   // input change to output change, kept across inserts
+void        vdutSetFault(uint8_t bank, const Fault &f); // FAULT_NONE clears it
+const char *faultName(FaultKind kind);
+
+// Every stuck-at fault on the signal pins, an open on every input and clock
+// and a bridge between every two neighbouring signal pins. Returns the
+// count, writing at most max of them.
+uint16_t    vdutFaultList(const ICProfile &ic, Fault *out, uint16_t max);
+
+#endif
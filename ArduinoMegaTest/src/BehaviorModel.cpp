@@ -0,0 +1,105 @@
+#include "BehaviorModel.h"
+
+#define PIN(n)      (1u<<((n)-1))
+#define HI(word, n) (((word)>>((n)-1)) & 1)
+
+// --- 194: MR=1 DSR=2 D0-D3=3-6 DSL=7 S0=9 S1=10 CP=11 Q3..Q0=12..15 ---
+static uint16_t eval194(const ModelState &st, uint16_t w) {
+  uint8_t q = HI(w,1) ? st.q : 0;
+  return (q&1 ? PIN(15):0) | (q&2 ? PIN(14):0) | (q&4 ? PIN(13):0) | (q&8 ? PIN(12):0);
+}
+
+static void step194(ModelState &st, uint16_t prev, uint16_t w) {
+  if (!HI(w,1)) { st.q=0; return; }                  // MR is active low
+  if (HI(prev,11) || !HI(w,11)) return;              // rising CP only
+  switch (HI(w,9) | HI(w,10)<<1) {
+    case 1: st.q = ((st.q<<1) | HI(w,2)) & 0x0F; break;          // shift right: DSR -> Q0
+    case 2: st.q = (st.q>>1) | HI(w,7)<<3; break;                // shift left:  DSL -> Q3
+    case 3: st.q = HI(w,3) | HI(w,4)<<1 | HI(w,5)<<2 | HI(w,6)<<3; break;
+    default: break;                                               // hold
+  }
+}
+
+// --- 7485: B3=1 I<=2 I==3 I>=4 O>=5 O==6 O<=7 B0=9 A0=10 B1=11 A1=12 A2=13 B2=14 A3=15 ---
+static uint16_t eval7485(uint16_t w) {
+  uint8_t a = HI(w,10) | HI(w,12)<<1 | HI(w,13)<<2 | HI(w,15)<<3;
+  uint8_t b = HI(w,9)  | HI(w,11)<<1 | HI(w,14)<<2 | HI(w,1)<<3;
+  if (a>b) return PIN(5);
+  if (a<b) return PIN(7);
+  // Equal words: the cascade inputs decide (74LS85 function table).
+  if (HI(w,3)) return PIN(6);
+  bool gt=HI(w,4), lt=HI(w,2);
+  if (gt && !lt) return PIN(5);
+  if (lt && !gt) return PIN(7);
+  return gt ? 0 : PIN(5)|PIN(7);
+}
+
+// --- 7473: CLK1=1 CLR1=2 K1=3 CLK2=5 CLR2=6 J2=7 | Q2N=10 Q2=11 K2=12 Q1=14 Q1N=15 J1=16 ---
+// (14-pin part: chip pins 8-14 sit on socket pins 10-16)
+static uint16_t eval7473(const ModelState &st, uint16_t w) {
+  bool q1 = HI(w,2) && (st.q&1), q2 = HI(w,6) && (st.q&2);
+  return (q1 ? PIN(14):PIN(15)) | (q2 ? PIN(11):PIN(10));
+}
+
+static uint8_t jk(uint8_t q, bool j, bool k) {
+  return j&&k ? !q : j ? 1 : k ? 0 : q;
+}
+
+static void step7473(ModelState &st, uint16_t prev, uint16_t w) {
+  uint8_t q1=st.q&1, q2=(st.q>>1)&1;
+  if (!HI(w,2)) q1=0;                                       // CLR is active low
+  else if (HI(prev,1) && !HI(w,1)) q1=jk(q1, HI(w,16), HI(w,3));  // falling CLK
+  if (!HI(w,6)) q2=0;
+  else if (HI(prev,5) && !HI(w,5)) q2=jk(q2, HI(w,7), HI(w,12));
+  st.q = q1 | q2<<1;
+}
+
+// --- 74139: 1E=1 1A0=2 1A1=3 1Y0-1Y3=4-7 | 2Y3-2Y0=9-12 2A1=13 2A0=14 2E=15 ---
+static uint16_t eval74139(uint16_t w) {
+  static const uint8_t Y1[4]={4,5,6,7}, Y2[4]={12,11,10,9};
+  uint16_t out = PIN(4)|PIN(5)|PIN(6)|PIN(7)|PIN(9)|PIN(10)|PIN(11)|PIN(12);
+  if (!HI(w,1))  out &= ~PIN(Y1[HI(w,2) | HI(w,3)<<1]);
+  if (!HI(w,15)) out &= ~PIN(Y2[HI(w,14) | HI(w,13)<<1]);
+  return out;
+}
+
+// --- 74157: S=1 1A=2 1B=3 1Y=4 2A=5 2B=6 2Y=7 3Y=9 3B=10 3A=11 4Y=12 4B=13 4A=14 E=15 ---
+static uint16_t eval74157(uint16_t w) {
+  if (HI(w,15)) return 0;                             // E is active low
+  bool s=HI(w,1);
+  return ((s ? HI(w,3)  : HI(w,2))  ? PIN(4)  : 0) |
+         ((s ? HI(w,6)  : HI(w,5))  ? PIN(7)  : 0) |
+         ((s ? HI(w,10) : HI(w,11)) ? PIN(9)  : 0) |
+         ((s ? HI(w,13) : HI(w,14)) ? PIN(12) : 0);
+}
+
+void modelReset(ModelState &st) {
+  st.q=0;
+}
+
+uint16_t modelEvaluate(const ICProfile &ic, const ModelState &st, uint16_t word) {
+  switch (ic.model) {
+    case MODEL_SHIFT_194: return eval194(st, word);
+    case MODEL_CMP_7485:  return eval7485(word);
+    case MODEL_JK_7473:   return eval7473(st, word);
+    case MODEL_DEC_74139: return eval74139(word);
+    case MODEL_MUX_74157: return eval74157(word);
+    default:              return 0;
+  }
+}
+
+void modelStep(const ICProfile &ic, ModelState &st, uint16_t prev, uint16_t word) {
+  switch (ic.model) {
+    case MODEL_SHIFT_194: step194(st, prev, word); break;
+    case MODEL_JK_7473:   step7473(st, prev, word); break;
+    default: break;
+  }
+}
+
+uint16_t expectedOutputs(const ICProfile &ic, const ModelState &st, uint16_t word) {
+  return gateOutputs(ic, word) | modelEvaluate(ic, st, word);
+}
+
+uint16_t checkedOutputMask(const ICProfile &ic) {
+  return ic.model!=MODEL_NONE ? ic.outputMask : gateOutputMask(ic);
+}
@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include "Buttons.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+static const uint8_t BUTTON_PINS[BUTTON_COUNT] = {2, 3, 4, 5, 6, 7, 8, 9};
+
+static uint8_t level=0;                     // debounced, bit per button, 1 = pressed
+static uint8_t count[BUTTON_COUNT];         // ticks the pin has disagreed with level
+static volatile uint32_t ticks=0;
+static ButtonEvent ring[BUTTON_EVENTS];
+static volatile uint8_t ringHead=0, ringTail=0;
+static volatile uint16_t lost=0;
+
+// Raw pressed bits of all eight buttons.
+static uint8_t sample() {
+#if defined(__AVR__)
+  // pin 2 PE4, 3 PE5, 4 PG5, 5 PE3, 6..9 PH3..PH6
+  uint8_t e=PINE, g=PING, h=PINH;
+  return ~(((e>>4)&0x03) | ((g>>3)&0x04) | (e&0x08) | ((h<<1)&0xF0));
+#else
+  uint8_t b=0;
+  for (uint8_t i=0; i<BUTTON_COUNT; i++) if (!digitalRead(BUTTON_PINS[i])) b|=1<<i;
+  return b;
+#endif
+}
+
+static void buttonTick() {
+  ticks++;
+  uint8_t diff=sample()^level;
+  for (uint8_t i=0; i<BUTTON_COUNT; i++) {
+    if (!(diff & (1<<i))) { count[i]=0; continue; }
+    if (++count[i]<BUTTON_STABLE_MS) continue;
+    count[i]=0;
+    level^=1<<i;
+    uint8_t next=(ringHead+1)&(BUTTON_EVENTS-1);
+    if (next==ringTail) { lost++; continue; }
+    ButtonEvent &e=ring[ringHead];
+    e.button=i; e.pressed=level&(1<<i); e.ms=ticks;
+    ringHead=next;
+  }
+}
+
+#if defined(__AVR__)
+ISR(TIMER4_COMPA_vect) { buttonTick(); }
+#else
+static unsigned long lastTickUs=0;
+#endif
+
+void buttonsBegin() {
+  for (uint8_t i=0; i<BUTTON_COUNT; i++) { pinMode(BUTTON_PINS[i], INPUT_PULLUP); count[i]=0; }
+  level=0;
+  ticks=0;
+  ringHead=ringTail=0;
+#if defined(__AVR__)
+  TCCR4A=0;
+  TCCR4B=_BV(WGM42)|_BV(CS41)|_BV(CS40);    // CTC, clk/64
+  OCR4A=F_CPU/64/BUTTON_TICK_HZ-1;
+  TIMSK4|=_BV(OCIE4A);
+#else
+  lastTickUs=micros();
+#endif
+}
+
+bool buttonRead(ButtonEvent &e) {
+  if (ringTail==ringHead) return false;
+  e=ring[ringTail];
+  ringTail=(ringTail+1)&(BUTTON_EVENTS-1);
+  return true;
+}
+
+bool buttonDown(uint8_t button) { return level & (1<<button); }
+
+uint16_t buttonEventsLost() { return lost; }
+
+uint32_t buttonTicks() {
+#if defined(__AVR__)
+  uint8_t sreg=SREG; cli();
+  uint32_t t=ticks;
+  SREG=sreg;
+  return t;
+#else
+  return ticks;
+#endif
+}
+
+void buttonService() {
+#if !defined(__AVR__)
+  const unsigned long tickUs=1000000UL/BUTTON_TICK_HZ;
+  while (micros()-lastTickUs>=tickUs) {
+    lastTickUs+=tickUs;
+    buttonTick();
+  }
+#endif
+}
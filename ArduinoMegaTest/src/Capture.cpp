@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include "Capture.h"
+#include "PinBank.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+static uint16_t buf[CAPTURE_DEPTH];
+static volatile CaptureState state=CAP_IDLE;
+static volatile uint16_t head=0, filled=0, postLeft=0, trigPos=0;
+static uint16_t preWanted=0, trigMask=0, trigValue=0;
+static uint8_t bank=0;
+static bool lastMatch=true;
+static uint32_t rate=0;
+static uint16_t start=0, length=0, trigIndex=0, readPos=0;
+
+static void finish() {
+  // The record ends at head; it holds the trigger, what came after it and
+  // as much of the requested pre-trigger history as was sampled.
+  uint16_t oldest=(head-filled)&(CAPTURE_DEPTH-1);
+  uint16_t pre=(trigPos-oldest)&(CAPTURE_DEPTH-1);
+  if (pre>preWanted) pre=preWanted;
+  start=(trigPos-pre)&(CAPTURE_DEPTH-1);
+  length=(head-start)&(CAPTURE_DEPTH-1);
+  if (!length) length=CAPTURE_DEPTH;
+  trigIndex=pre;
+  readPos=0;
+  state=CAP_DONE;
+#if defined(__AVR__)
+  TIMSK3&=~_BV(OCIE3A);
+#endif
+}
+
+static void captureTick() {
+  uint16_t w=pinBankRead(bank);
+  uint16_t at=head;
+  buf[at]=w;
+  head=(at+1)&(CAPTURE_DEPTH-1);
+  if (filled<CAPTURE_DEPTH) filled++;
+  if (state==CAP_ARMED) {
+    bool match=(w&trigMask)==trigValue;
+    if (match && (!trigMask || !lastMatch)) {
+      trigPos=at;
+      postLeft=CAPTURE_DEPTH-preWanted-1;
+      state=CAP_TRIGGERED;
+      if (!postLeft) finish();
+    }
+    lastMatch=match;
+  } else if (state==CAP_TRIGGERED) {
+    if (!--postLeft) finish();
+  }
+}
+
+#if defined(__AVR__)
+ISR(TIMER3_COMPA_vect) { captureTick(); }
+#else
+static unsigned long lastSampleUs=0;
+static unsigned long periodUs=0;
+#endif
+
+void captureBegin() {
+#if defined(__AVR__)
+  TCCR3A=0;
+  TCCR3B=_BV(WGM32)|_BV(CS30);              // CTC, clk/1
+#endif
+  state=CAP_IDLE;
+}
+
+bool captureStart(uint8_t b, uint32_t hz, uint16_t pre, uint16_t mask, uint16_t value) {
+  if (!hz || hz>CAPTURE_MAX_HZ || pre>=CAPTURE_DEPTH || b>=PIN_BANKS) return false;
+  captureStop();
+  bank=b;
+  head=filled=0;
+  preWanted=pre; trigMask=mask; trigValue=value&mask;
+  lastMatch=true;
+  rate=hz;
+  state=CAP_ARMED;
+#if defined(__AVR__)
+  // Smallest prescaler whose period fits the 16-bit OCR3A.
+  static const uint16_t div[]={1, 8, 64, 256, 1024};
+  uint8_t cs=0;
+  while (F_CPU/div[cs]/hz>65536UL) cs++;
+  TCCR3B=_BV(WGM32)|(cs+1);                 // CS3x = 1..5 select clk/1..clk/1024
+  OCR3A=F_CPU/div[cs]/hz-1;
+  TCNT3=0;
+  TIFR3=_BV(OCF3A);
+  TIMSK3|=_BV(OCIE3A);
+#else
+  periodUs=1000000UL/hz;
+  lastSampleUs=micros();
+#endif
+  return true;
+}
+
+void captureStop() {
+#if defined(__AVR__)
+  TIMSK3&=~_BV(OCIE3A);
+#endif
+  if (state==CAP_ARMED) trigPos=(head-1)&(CAPTURE_DEPTH-1);
+  if (state==CAP_ARMED || state==CAP_TRIGGERED) {
+    if (!filled) { state=CAP_IDLE; return; }
+    finish();
+  }
+}
+
+CaptureState captureState() { return state; }
+uint16_t captureLength() { return length; }
+uint16_t captureTriggerIndex() { return trigIndex; }
+uint32_t captureRate() { return rate; }
+
+bool captureRead(uint16_t &word) {
+  if (state!=CAP_DONE || readPos==length) return false;
+  word=buf[(start+readPos++)&(CAPTURE_DEPTH-1)];
+  return true;
+}
+
+void captureRelease() {
+  if (state==CAP_DONE) state=CAP_IDLE;
+}
+
+void captureService() {
+#if !defined(__AVR__)
+  while ((state==CAP_ARMED || state==CAP_TRIGGERED) && micros()-lastSampleUs>=periodUs) {
+    lastSampleUs+=periodUs;
+    captureTick();
+  }
+#endif
+}
@@ -0,0 +1,215 @@
+#include <Arduino.h>
+#include "ClockGen.h"
+#include "PinBank.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#define CLOCK_ATOMIC_BEGIN uint8_t sreg_ = SREG; cli();
+#define CLOCK_ATOMIC_END   SREG = sreg_;
+#define CLOCK_IRQ_ON()     (TIMSK1 |= _BV(OCIE1A))
+#define CLOCK_IRQ_OFF()    (TIMSK1 &= ~_BV(OCIE1A))
+#else
+#define CLOCK_ATOMIC_BEGIN
+#define CLOCK_ATOMIC_END
+#define CLOCK_IRQ_ON()
+#define CLOCK_IRQ_OFF()
+#endif
+
+struct ClockChannel {
+  uint16_t  mask;        // socket bit driven by this channel
+  uint8_t   bank;
+  uint32_t  inc;         // accumulator step per tick, 2^32 = one edge
+  uint32_t  acc;
+  uint32_t  delay;       // ticks before the first edge
+  uint32_t  edgesLeft;   // 0 = free running
+  uint32_t  edges;       // emitted since clockStart()
+  bool      level, armed, burst;
+  ClockEdge sample;
+  // As configured; clockStart() reloads inc, delay and edgesLeft from these.
+  uint32_t  cfgInc, cfgDelay, cfgEdges;
+};
+
+static ClockChannel ch[CLOCK_CHANNELS];
+static uint8_t nChannels=0;
+static volatile uint8_t running=0;          // bit per channel
+static volatile uint16_t ring[CLOCK_SAMPLES];
+static volatile uint8_t ringHead=0, ringTail=0;
+static volatile uint16_t lost=0;
+
+// One timer tick: advance every running channel and apply all of this
+// tick's edges with a single toggle so simultaneous edges stay simultaneous.
+static void clockTick() {
+  uint16_t toggle[PIN_BANKS]={0};
+  uint8_t sampleNow=0, sampleBank=0;
+  for (uint8_t i=0; i<nChannels; i++) {
+    if (!(running & (1<<i))) continue;
+    ClockChannel &c=ch[i];
+    if (c.delay) { c.delay--; continue; }
+    uint32_t before=c.acc;
+    c.acc+=c.inc;
+    if (c.acc>=before) continue;            // no wrap, no edge
+    toggle[c.bank]|=c.mask;
+    c.level=!c.level;
+    c.edges++;
+    if (!sampleNow && ((c.sample==EDGE_RISING && c.level) || (c.sample==EDGE_FALLING && !c.level))) {
+      sampleNow=1; sampleBank=c.bank;
+    }
+    if (c.burst && !--c.edgesLeft) running&=~(1<<i);
+  }
+  if (!running) CLOCK_IRQ_OFF();
+  for (uint8_t b=0; b<PIN_BANKS; b++) if (toggle[b]) pinBankToggle(b, toggle[b]);
+  if (!sampleNow) return;
+  uint8_t next=(ringHead+1)&(CLOCK_SAMPLES-1);
+  if (next==ringTail) { lost++; return; }
+  ring[ringHead]=pinBankRead(sampleBank);
+  ringHead=next;
+}
+
+#if defined(__AVR__)
+ISR(TIMER1_COMPA_vect) { clockTick(); }
+#else
+static unsigned long lastTickUs=0;
+#endif
+
+void clockBegin() {
+#if defined(__AVR__)
+  TCCR1A=0;
+  TCCR1B=_BV(WGM12)|_BV(CS11);              // CTC, clk/8 = 2 MHz
+  OCR1A=F_CPU/8/CLOCK_TICK_HZ-1;
+  CLOCK_IRQ_OFF();                          // until a channel starts
+#else
+  lastTickUs=micros();
+#endif
+  clockReset();
+}
+
+void clockReset() {
+  clockStop();
+  nChannels=0;
+  ringHead=ringTail=0;
+  lost=0;
+}
+
+int8_t clockAttach(uint8_t bank, uint8_t pin) {
+  if (nChannels==CLOCK_CHANNELS || bank>=PIN_BANKS) return -1;
+  ClockChannel &c=ch[nChannels];
+  memset(&c, 0, sizeof(c));
+  c.mask=1u<<pin;
+  c.bank=bank;
+  return nChannels++;
+}
+
+uint8_t clockChannels() { return nChannels; }
+
+uint8_t clockChannelPin(uint8_t i) {
+  for (uint8_t b=0; b<PIN_BANK_SIZE; b++) if (ch[i].mask & (1u<<b)) return b;
+  return 255;
+}
+
+uint8_t clockChannelBank(uint8_t i) { return ch[i].bank; }
+
+static bool validHz(float hz) { return hz>0 && hz<=CLOCK_MAX_HZ; }
+
+// Two edges per period: inc = 2 * hz / tick * 2^32.
+static uint32_t accStep(float hz) {
+  float inc=hz*2.0f/CLOCK_TICK_HZ*4294967296.0f;
+  return inc>=4294967295.0f ? 0xFFFFFFFF : (uint32_t)inc;
+}
+
+bool clockConfigure(uint8_t i, float hz, uint32_t edges, uint16_t phaseDeg) {
+  if (i>=nChannels || !validHz(hz)) return false;
+  ClockChannel &c=ch[i];
+  CLOCK_ATOMIC_BEGIN
+  running&=~(1<<i);
+  c.cfgInc=accStep(hz);
+  c.cfgDelay=(uint32_t)((phaseDeg%360)/360.0f*CLOCK_TICK_HZ/hz);
+  c.cfgEdges=edges;
+  c.armed=true;
+  CLOCK_ATOMIC_END
+  return true;
+}
+
+void clockSampleOn(uint8_t i, ClockEdge edge) {
+  if (i<nChannels) ch[i].sample=edge;
+}
+
+// Loads the channels in go from their configuration, or as a two-edge pulse
+// when pulseInc is set, and sets them running on the same tick. Everything
+// happens with the timer held off: some of them may be running already.
+static void launch(uint8_t go, uint32_t pulseInc) {
+  uint16_t low[PIN_BANKS]={0};
+  CLOCK_ATOMIC_BEGIN
+  for (uint8_t i=0; i<nChannels; i++) {
+    if (!(go & (1<<i))) continue;
+    ClockChannel &c=ch[i];
+    c.inc=pulseInc ? pulseInc : c.cfgInc;
+    c.delay=pulseInc ? 0 : c.cfgDelay;
+    c.edgesLeft=pulseInc ? 2 : c.cfgEdges;
+    c.burst=c.edgesLeft>0;
+    c.acc=0xFFFFFFFF;                       // first tick after the delay is an edge
+    c.level=false;
+    c.edges=0;
+    low[c.bank]|=c.mask;
+  }
+  for (uint8_t b=0; b<PIN_BANKS; b++) if (low[b]) pinBankWrite(b, 0, low[b]);
+#if defined(__AVR__)
+  if (go && !running) { TCNT1=0; TIFR1=_BV(OCF1A); }  // first tick a full period away
+#endif
+  running|=go;
+  if (running) CLOCK_IRQ_ON();
+  CLOCK_ATOMIC_END
+}
+
+void clockStart(uint8_t chMask) {
+  uint8_t go=0;
+  for (uint8_t i=0; i<nChannels; i++) if (ch[i].armed && (chMask & (1<<i))) go|=1<<i;
+  launch(go, 0);
+}
+
+bool clockPulse(uint8_t chMask, float hz) {
+  if (!validHz(hz)) return false;
+  launch(chMask & ((1<<nChannels)-1), accStep(hz));
+  return true;
+}
+
+void clockStop(uint8_t chMask) {
+  uint16_t low[PIN_BANKS]={0};
+  CLOCK_ATOMIC_BEGIN
+  running&=~chMask;
+  if (!running) CLOCK_IRQ_OFF();
+  for (uint8_t i=0; i<nChannels; i++) {
+    if (!(chMask & (1<<i))) continue;
+    low[ch[i].bank]|=ch[i].mask;
+    ch[i].level=false;
+  }
+  for (uint8_t b=0; b<PIN_BANKS; b++) if (low[b]) pinBankWrite(b, 0, low[b]);
+  CLOCK_ATOMIC_END
+}
+
+bool clockBusy(uint8_t chMask) { return (running & chMask)!=0; }
+
+uint32_t clockEdgeCount(uint8_t i) {
+  CLOCK_ATOMIC_BEGIN
+  uint32_t n=i<nChannels ? ch[i].edges : 0;
+  CLOCK_ATOMIC_END
+  return n;
+}
+
+bool clockReadSample(uint16_t &word) {
+  if (ringTail==ringHead) return false;
+  word=ring[ringTail];
+  ringTail=(ringTail+1)&(CLOCK_SAMPLES-1);
+  return true;
+}
+
+uint16_t clockSamplesLost() { return lost; }
+
+void clockService() {
+#if !defined(__AVR__)
+  const unsigned long tickUs=1000000UL/CLOCK_TICK_HZ;
+  while (micros()-lastTickUs>=tickUs) {
+    lastTickUs+=tickUs;
+    if (running) clockTick();
+  }
+#endif
+}
@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include "ICDatabase.h"
+
+// IC_DB, IC_DB_COUNT and findProfile() are generated into ICTable.gen.cpp
+// from FrontEnd/digitalkit/public/files/*.json (see icgen.py). Every part
+// sits in the 16-pin socket from pin 1, so on a 14-pin part chip pins 8-14
+// land on socket pins 10-16 and socket pins 8/9 are left NC, wherever its
+// supply pins are; 16-pin parts sit pin-for-pin.
+
+void loadProfile(uint8_t index, ICProfile &out) {
+  memcpy_P(&out, &IC_DB[index], sizeof(ICProfile));
+}
+
+void loadTestSet(uint8_t index, ICTestSet &out) {
+  memcpy_P(&out, &IC_TEST_SETS[index], sizeof(ICTestSet));
+}
+
+PinRole pinRole(const ICProfile &ic, uint8_t pin) {
+  uint16_t b = 1u<<pin;
+  if (ic.inputMask & b)  return ROLE_INPUT;
+  if (ic.outputMask & b) return ROLE_OUTPUT;
+  if (ic.clockMask & b)  return ROLE_CLOCK;
+  if (ic.vccMask & b)    return ROLE_VCC;
+  if (ic.gndMask & b)    return ROLE_GND;
+  return ROLE_NC;
+}
+
+bool evaluateGate(const LogicGate &g, uint16_t word) {
+  uint8_t ones=0;
+  for (uint8_t k=0; k<g.inputCount; k++)
+    if (word & (1u<<(g.inputs[k]-1))) ones++;
+  bool all = ones==g.inputCount, any = ones>0, odd = ones&1;
+  switch (g.type) {
+    case AND:  return all;
+    case OR:   return any;
+    case NAND: return !all;
+    case NOR:  return !any;
+    case XOR:  return odd;
+    case XNOR: return !odd;
+    case NOT:  return !any;
+  }
+  return false;
+}
+
+uint16_t gateOutputs(const ICProfile &ic, uint16_t word) {
+  uint16_t out=0;
+  for (uint8_t i=0; i<ic.gateCount; i++)
+    if (evaluateGate(ic.gates[i], word)) out |= 1u<<(ic.gates[i].output-1);
+  return out;
+}
+
+uint16_t gateInputMask(const ICProfile &ic) {
+  uint16_t m=0;
+  for (uint8_t i=0; i<ic.gateCount; i++)
+    for (uint8_t k=0; k<ic.gates[i].inputCount; k++) m |= 1u<<(ic.gates[i].inputs[k]-1);
+  return m;
+}
+
+uint16_t gateOutputMask(const ICProfile &ic) {
+  uint16_t m=0;
+  for (uint8_t i=0; i<ic.gateCount; i++) m |= 1u<<(ic.gates[i].output-1);
+  return m;
+}
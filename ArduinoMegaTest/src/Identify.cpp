@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "Identify.h"
+#include "PinBank.h"
+
+static bool samePinout(const ICProfile &a, const ICProfile &b) {
+  return a.vccMask==b.vccMask && a.gndMask==b.gndMask &&
+         a.inputMask==b.inputMask && a.outputMask==b.outputMask;
+}
+
+// Profiles that fit the candidate set.
+static uint8_t partCount() {
+  return IC_DB_COUNT<IDENTIFY_MAX_PARTS ? IC_DB_COUNT : IDENTIFY_MAX_PARTS;
+}
+
+uint32_t identifyCandidates(const ICProfile &ref) {
+  uint32_t set=0;
+  for (uint8_t i=0; i<partCount(); i++) {
+    ICProfile p;
+    loadProfile(i, p);
+    if (p.gateCount && samePinout(p, ref)) set |= 1UL<<i;
+  }
+  return set;
+}
+
+// Spreads the low bits of n over the set bits of mask.
+static uint16_t deposit(uint16_t n, uint16_t mask) {
+  uint16_t w=0;
+  for (uint16_t b=1; mask; b<<=1) {
+    uint16_t low=mask & -mask;
+    if (n & b) w |= low;
+    mask &= mask-1;
+  }
+  return w;
+}
+
+static uint16_t predict(uint8_t idx, uint16_t word) {
+  ICProfile p;
+  loadProfile(idx, p);
+  return gateOutputs(p, word);
+}
+
+// Size of the largest group of candidates predicting the same outputs.
+static uint8_t worstGroup(uint32_t cand, uint16_t word) {
+  uint16_t seen[32];
+  uint8_t size[32], groups=0, worst=0;
+  for (uint8_t i=0; i<partCount(); i++) {
+    if (!(cand & (1UL<<i))) continue;
+    uint16_t out=predict(i, word);
+    uint8_t g=0;
+    while (g<groups && seen[g]!=out) g++;
+    if (g==groups) { seen[groups]=out; size[groups++]=0; }
+    if (++size[g]>worst) worst=size[g];
+  }
+  return worst;
+}
+
+static uint8_t popcount32(uint32_t v) {
+  uint8_t n=0;
+  for (; v; v&=v-1) n++;
+  return n;
+}
+
+void identifyPart(const ICProfile &ref, uint8_t bank, IdentifyResult &r) {
+  r.remaining=identifyCandidates(ref);
+  r.vectors=0;
+  uint8_t inputs=popcount32(ref.inputMask);
+  uint32_t combos=1UL<<inputs;
+  while (popcount32(r.remaining)>1 && r.vectors<IDENTIFY_MAX_STEPS) {
+    uint8_t n=popcount32(r.remaining), best=n;
+    uint16_t bestWord=0;
+    for (uint32_t c=0; c<combos && best>1; c++) {
+      uint16_t w=deposit(c, ref.inputMask);
+      uint8_t worst=worstGroup(r.remaining, w);
+      if (worst<best) { best=worst; bestWord=w; }
+    }
+    if (best==n) break;                      // nothing left that tells them apart
+    pinBankWrite(bank, bestWord, ref.inputMask);
+    delayMicroseconds(IDENTIFY_SETTLE_US);
+    uint16_t got=pinBankRead(bank) & ref.outputMask;
+    r.vectors++;
+    for (uint8_t i=0; i<partCount(); i++)
+      if ((r.remaining & (1UL<<i)) && predict(i, bestWord)!=got) r.remaining &= ~(1UL<<i);
+  }
+  r.index=-1;
+  if (popcount32(r.remaining)!=1) return;
+  for (uint8_t i=0; i<partCount(); i++) if (r.remaining & (1UL<<i)) r.index=i;
+  // Confirm the survivor: these patterns give every gate of a 1- or 2-input
+  // part all of its input combinations, so a dead or foreign chip that
+  // happened to match the splitting vectors is still rejected.
+  static const uint16_t confirm[4]={0x0000, 0xFFFF, 0x5555, 0xAAAA};
+  for (uint8_t k=0; k<4; k++) {
+    uint16_t w=deposit(confirm[k], ref.inputMask);
+    pinBankWrite(bank, w, ref.inputMask);
+    delayMicroseconds(IDENTIFY_SETTLE_US);
+    r.vectors++;
+    if ((pinBankRead(bank) & ref.outputMask)!=predict(r.index, w)) {
+      r.index=-1; r.remaining=0;
+      return;
+    }
+  }
+}
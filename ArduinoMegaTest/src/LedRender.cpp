@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include <FastLED.h>
+#include "LedRender.h"
+
+static CRGB leds[LED_COUNT];
+static uint8_t ledPin[LED_COUNT];       // socket bit shown by each LED, 255 = none
+static uint8_t dirty=0;                 // bit per strip
+static uint32_t lastActivity=0;
+static unsigned long quietSince=0;
+static bool waiting=false;
+
+uint16_t ledFrames=0;
+uint16_t ledDeferrals=0;
+
+static void setLed(uint8_t i, const CRGB &c) {
+  if (leds[i]==c) return;
+  leds[i]=c;
+  dirty|=1<<(i/LEDS_PER_STRIP);
+}
+
+void ledBegin() {
+  FastLED.addLeds<WS2812, LED_PIN_STRIP1, GRB>(leds, LEDS_PER_STRIP);
+  FastLED.addLeds<WS2812, LED_PIN_STRIP2, GRB>(leds+LEDS_PER_STRIP, LEDS_PER_STRIP);
+  FastLED.addLeds<WS2812, LED_PIN_STRIP3, GRB>(leds+2*LEDS_PER_STRIP, LEDS_PER_STRIP);
+  ledMap(0);
+  dirty=(1<<LED_STRIPS)-1;              // strips power up in an unknown state
+}
+
+void ledMap(uint16_t outputMask) {
+  uint8_t n=0;
+  for (uint8_t p=0; p<16 && n<LED_COUNT; p++)
+    if (outputMask & (1u<<p)) ledPin[n++]=p;
+  for (uint8_t i=0; i<LED_COUNT; i++) {
+    if (i>=n) ledPin[i]=255;
+    setLed(i, CRGB::Black);
+  }
+}
+
+void ledUpdate(uint16_t word) {
+  for (uint8_t i=0; i<LED_COUNT; i++)
+    if (ledPin[i]!=255) setLed(i, (word & (1u<<ledPin[i])) ? CRGB::Green : CRGB::Red);
+}
+
+void ledService(uint32_t rxActivity) {
+  if (rxActivity!=lastActivity) { lastActivity=rxActivity; quietSince=millis(); }
+  if (!dirty) return;
+  if (millis()-quietSince<LED_QUIET_MS) {
+    if (!waiting) { waiting=true; ledDeferrals++; }
+    return;
+  }
+  waiting=false;
+  for (uint8_t s=0; s<LED_STRIPS; s++) {
+    if (!(dirty & (1<<s))) continue;
+    FastLED[s].showLeds(255);
+    ledFrames++;
+  }
+  dirty=0;
+}
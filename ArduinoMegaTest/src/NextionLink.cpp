@@ -0,0 +1,185 @@
+#include "NextionLink.h"
+
+struct NextionSlot {
+  char    text[NEXTION_CMD_MAX];
+  uint8_t len;
+  uint8_t keyLen;     // 0 for events, which never coalesce
+};
+
+static NextionSlot slots[NEXTION_SLOTS];
+static uint8_t head=0, count=0;
+static uint8_t sent=0;                   // bytes of slots[head] already written, incl. terminators
+static char    rxBuf[NEXTION_RX_MAX];
+static uint8_t rxLen=0;
+static unsigned long rxLast=0;
+static unsigned long linkBaud=NEXTION_BAUD_DEFAULT;
+static unsigned long lastRefresh=0;
+
+uint16_t nextionDropped=0;
+uint16_t nextionCoalesced=0;
+DisplayCache nextionCache;
+LinkCounters nextionLink;
+
+static const uint32_t BAUDS[] PROGMEM = {
+  2400, 4800, 9600, 19200, 31250, 38400, 57600, 115200, 230400, 250000, 256000, 512000, 921600};
+
+bool nextionValidBaud(unsigned long baud) {
+  for (uint8_t i=0; i<sizeof(BAUDS)/sizeof(BAUDS[0]); i++)
+    if (pgm_read_dword(&BAUDS[i])==baud) return true;
+  return false;
+}
+
+unsigned long nextionBaud() {
+  return linkBaud;
+}
+
+static void openAt(unsigned long baud) {
+  NEXTION_SERIAL.flush();
+  NEXTION_SERIAL.end();
+  NEXTION_SERIAL.begin(baud, SERIAL_8N1);
+  linkBaud=baud;
+}
+
+static void writeCommand(const char *cmd, unsigned long arg=0) {
+  NEXTION_SERIAL.print(cmd);
+  if (arg) NEXTION_SERIAL.print(arg);
+  for (uint8_t i=0; i<3; i++) NEXTION_SERIAL.write(0xFF);
+}
+
+// "sendme" is answered with 66 <page> FF FF FF whatever bkcmd is set to. The
+// leading terminator flushes any half command the display still holds.
+static bool probe() {
+  while (NEXTION_SERIAL.available()) NEXTION_SERIAL.read();
+  writeCommand("");
+  writeCommand("sendme");
+  uint8_t n=0;
+  for (uint8_t ms=0; ms<NEXTION_PROBE_MS; ms++) {
+    while (NEXTION_SERIAL.available()) {
+      uint8_t c=NEXTION_SERIAL.read();
+      if (n==0 && c!=0x66) continue;
+      if (n>=2 && c!=0xFF) { n=0; continue; }
+      if (++n==5) return true;
+    }
+    delay(1);
+  }
+  return false;
+}
+
+unsigned long nextionBegin(unsigned long target) {
+  if (!nextionValidBaud(target)) target=NEXTION_BAUD_DEFAULT;
+  nextionInvalidate();
+  // baud= lasts until the display is power-cycled, so after a tester reset
+  // it is usually still at the target rate.
+  if (target!=NEXTION_BAUD_DEFAULT) {
+    openAt(target);
+    if (probe()) return target;
+  }
+  openAt(NEXTION_BAUD_DEFAULT);
+  bool present=probe();
+  if (!present || target==NEXTION_BAUD_DEFAULT) return present ? NEXTION_BAUD_DEFAULT : 0;
+
+  writeCommand("baud=", target);
+  NEXTION_SERIAL.flush();
+  delay(NEXTION_SWITCH_MS);
+  openAt(target);
+  if (probe()) return target;
+
+  // The display may have switched without us hearing it; ask it back.
+  writeCommand("baud=", NEXTION_BAUD_DEFAULT);
+  NEXTION_SERIAL.flush();
+  delay(NEXTION_SWITCH_MS);
+  openAt(NEXTION_BAUD_DEFAULT);
+  return probe() ? NEXTION_BAUD_DEFAULT : 0;
+}
+
+static void enqueue(const String &cmd, bool state) {
+  uint8_t len=cmd.length();
+  const char *s=cmd.c_str();
+  if (cmd.length()>=NEXTION_CMD_MAX) { nextionDropped++; nextionCache.forget(s, NEXTION_CMD_MAX-1); return; }
+  // State "obj.attr=value" coalesces on "obj.attr=", "PINS:..." on "PINS:";
+  // events such as "CLOCK:PULSED" are all kept.
+  uint8_t key=state ? DisplayCache::keyLength(s, len) : 0;
+  // The head slot may already be on the wire; anything behind it is fair game.
+  for (uint8_t i=(sent?1:0); key && i<count; i++) {
+    NextionSlot &q=slots[(head+i)%NEXTION_SLOTS];
+    if (q.keyLen==key && !memcmp(q.text, s, key)) {
+      memcpy(q.text, s, len); q.len=len;
+      nextionCoalesced++;
+      return;
+    }
+  }
+  if (count==NEXTION_SLOTS) {
+    // Drop the oldest command that is not in flight.
+    uint8_t victim=(head+(sent?1:0))%NEXTION_SLOTS;
+    nextionCache.forget(slots[victim].text, slots[victim].len);
+    for (uint8_t i=victim; i!=(head+count-1)%NEXTION_SLOTS; i=(i+1)%NEXTION_SLOTS)
+      slots[i]=slots[(i+1)%NEXTION_SLOTS];
+    count--;
+    nextionDropped++;
+  }
+  NextionSlot &q=slots[(head+count)%NEXTION_SLOTS];
+  memcpy(q.text, s, len); q.len=len; q.keyLen=key;
+  count++;
+}
+
+void nextionQueue(const String &cmd) {
+  enqueue(cmd, false);
+}
+
+bool nextionShow(const String &cmd) {
+  if (!nextionCache.update(cmd.c_str(), cmd.length())) return false;
+  enqueue(cmd, true);
+  return true;
+}
+
+void nextionInvalidate() {
+  nextionCache.clear();
+}
+
+void nextionService() {
+  if (millis()-lastRefresh>=NEXTION_REFRESH_MS) { nextionInvalidate(); lastRefresh=millis(); }
+  int room=NEXTION_SERIAL.availableForWrite();
+  while (count && room>0) {
+    NextionSlot &q=slots[head];
+    uint8_t total=q.len+3;
+    while (sent<total && room>0) {
+      NEXTION_SERIAL.write(sent<q.len ? (uint8_t)q.text[sent] : 0xFF);
+      sent++; room--;
+    }
+    if (sent<total) return;
+    nextionLink.tx(total);
+    sent=0;
+    head=(head+1)%NEXTION_SLOTS;
+    count--;
+  }
+}
+
+uint8_t nextionPending() {
+  return count;
+}
+
+// Display messages end with '\n', with the 0xFF 0xFF 0xFF of a Nextion
+// return code, or with a short silence. Non-printable bytes are dropped.
+bool nextionReadLine(String &line) {
+  while (NEXTION_SERIAL.available()) {
+    char c=NEXTION_SERIAL.read();
+    rxLast=millis();
+    if (c=='\n' || c=='\r' || (uint8_t)c==0xFF) {
+      if (!rxLen) continue;
+      line=String();
+      for (uint8_t i=0;i<rxLen;i++) line+=rxBuf[i];
+      nextionLink.rx(rxLen+1);
+      rxLen=0;
+      return true;
+    }
+    if (c>=32 && c<=126 && rxLen<NEXTION_RX_MAX) rxBuf[rxLen++]=c;
+  }
+  if (rxLen && millis()-rxLast>=NEXTION_RX_IDLE_MS) {
+    line=String();
+    for (uint8_t i=0;i<rxLen;i++) line+=rxBuf[i];
+    nextionLink.rx(rxLen);
+    rxLen=0;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,254 @@
+#include "PinBank.h"
+
+// Socket bits owned by each port of bank 0; every other bit of PORTD/PORTG
+// belongs to something else and is left untouched. Bank 1 owns all of PORTF
+// and PORTK.
+#define MASK_A 0x55
+#define MASK_C 0xFF
+#define MASK_D 0x80
+#define MASK_G 0x07
+
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#define DDR_A DDRA
+#define DDR_C DDRC
+#define DDR_D DDRD
+#define DDR_G DDRG
+#define DDR_F DDRF
+#define DDR_K DDRK
+#define PORT_A PORTA
+#define PORT_C PORTC
+#define PORT_D PORTD
+#define PORT_G PORTG
+#define PORT_F PORTF
+#define PORT_K PORTK
+#define PIN_A PINA
+#define PIN_C PINC
+#define PIN_D PIND
+#define PIN_G PING
+#define PIN_F PINF
+#define PIN_K PINK
+// Writing 1s to PINx toggles the PORTx bits in a single cycle.
+#define TOGGLE(port, pin, m) (pin = (m))
+#define ATOMIC_BEGIN uint8_t sreg_ = SREG; cli();
+#define ATOMIC_END   SREG = sreg_;
+#define NOTIFY(bank)
+#define SAMPLE(bank)
+#else
+#include <Arduino.h>                      // delayMicroseconds() in virtual time
+struct MockPort { uint8_t ddr, port, ext; };
+static MockPort mockPort[6];                 // A, C, D, G (bank 0), F, K (bank 1)
+static uint8_t mockPin(uint8_t p) {
+  return (mockPort[p].ddr & mockPort[p].port) | (~mockPort[p].ddr & mockPort[p].ext);
+}
+void (*mockPinBankHook)(uint8_t bank) = nullptr;
+void (*mockPinBankSampleHook)(uint8_t bank) = nullptr;
+#define DDR_A mockPort[0].ddr
+#define DDR_C mockPort[1].ddr
+#define DDR_D mockPort[2].ddr
+#define DDR_G mockPort[3].ddr
+#define DDR_F mockPort[4].ddr
+#define DDR_K mockPort[5].ddr
+#define PORT_A mockPort[0].port
+#define PORT_C mockPort[1].port
+#define PORT_D mockPort[2].port
+#define PORT_G mockPort[3].port
+#define PORT_F mockPort[4].port
+#define PORT_K mockPort[5].port
+#define PIN_A mockPin(0)
+#define PIN_C mockPin(1)
+#define PIN_D mockPin(2)
+#define PIN_G mockPin(3)
+#define PIN_F mockPin(4)
+#define PIN_K mockPin(5)
+#define TOGGLE(port, pin, m) (port ^= (m))
+#define ATOMIC_BEGIN
+#define ATOMIC_END
+#define NOTIFY(bank) do { if (mockPinBankHook) mockPinBankHook(bank); } while (0)
+#define SAMPLE(bank) do { if (mockPinBankSampleHook) mockPinBankSampleHook(bank); } while (0)
+#endif
+
+struct PortBits { uint8_t a, c, d, g; };
+
+static inline uint8_t rev8(uint8_t b) {
+  b = (b>>4) | (b<<4);
+  b = ((b&0xCC)>>2) | ((b&0x33)<<2);
+  return ((b&0xAA)>>1) | ((b&0x55)<<1);
+}
+
+static inline PortBits toPorts(uint16_t w) {
+  PortBits p;
+  p.a = (w&0x01) | ((w<<1)&0x04) | ((w<<2)&0x10) | ((w<<3)&0x40);
+  p.c = rev8(w>>4);
+  p.d = (w>>5) & 0x80;
+  p.g = ((w>>11)&0x04) | ((w>>13)&0x02) | ((w>>15)&0x01);
+  return p;
+}
+
+static inline uint16_t fromPorts(uint8_t a, uint8_t c, uint8_t d, uint8_t g) {
+  uint16_t w = (a&0x01) | ((a>>1)&0x02) | ((a>>2)&0x04) | ((a>>3)&0x08);
+  w |= (uint16_t)rev8(c) << 4;
+  w |= (uint16_t)(d&0x80) << 5;
+  w |= ((uint16_t)(g&0x04)<<11) | ((uint16_t)(g&0x02)<<13) | ((uint16_t)(g&0x01)<<15);
+  return w;
+}
+
+void pinBankBegin() {
+#if defined(__AVR__)
+  // PF4-PF7 are the JTAG pins unless JTAG is switched off (two writes
+  // within four cycles).
+  uint8_t m = MCUCR | _BV(JTD);
+  MCUCR = m; MCUCR = m;
+#endif
+  for (uint8_t b=0; b<PIN_BANKS; b++) pinBankSetDirection(b, 0);
+}
+
+void pinBankSetDirection(uint8_t bank, uint16_t outputMask) {
+  if (bank) {
+    uint8_t f = outputMask, k = outputMask>>8;
+    ATOMIC_BEGIN
+    PORT_F &= f; DDR_F = f;
+    PORT_K &= k; DDR_K = k;
+    ATOMIC_END
+    NOTIFY(bank);
+    return;
+  }
+  PortBits m = toPorts(outputMask);
+  ATOMIC_BEGIN
+  // Released pins also lose their PORT bit so no pull-up is left behind.
+  PORT_A &= ~(MASK_A & ~m.a); DDR_A = (DDR_A & ~MASK_A) | m.a;
+  PORT_C &= ~(MASK_C & ~m.c); DDR_C = (DDR_C & ~MASK_C) | m.c;
+  PORT_D &= ~(MASK_D & ~m.d); DDR_D = (DDR_D & ~MASK_D) | m.d;
+  PORT_G &= ~(MASK_G & ~m.g); DDR_G = (DDR_G & ~MASK_G) | m.g;
+  ATOMIC_END
+  NOTIFY(bank);
+}
+
+uint16_t pinBankDirection(uint8_t bank) {
+  if (bank) return DDR_F | (uint16_t)DDR_K<<8;
+  return fromPorts(DDR_A, DDR_C, DDR_D, DDR_G);
+}
+
+void pinBankWrite(uint8_t bank, uint16_t word, uint16_t mask) {
+  if (bank) {
+    uint8_t vf = word, vk = word>>8, mf = mask, mk = mask>>8;
+    ATOMIC_BEGIN
+    PORT_F = (PORT_F & ~mf) | (vf & mf);
+    PORT_K = (PORT_K & ~mk) | (vk & mk);
+    ATOMIC_END
+    NOTIFY(bank);
+    return;
+  }
+  PortBits v = toPorts(word), m = toPorts(mask);
+  ATOMIC_BEGIN
+  PORT_A = (PORT_A & ~m.a) | (v.a & m.a);
+  PORT_C = (PORT_C & ~m.c) | (v.c & m.c);
+  PORT_D = (PORT_D & ~m.d) | (v.d & m.d);
+  PORT_G = (PORT_G & ~m.g) | (v.g & m.g);
+  ATOMIC_END
+  NOTIFY(bank);
+}
+
+void pinBankToggle(uint8_t bank, uint16_t mask) {
+  if (bank) {
+    ATOMIC_BEGIN
+    TOGGLE(PORT_F, PIN_F, (uint8_t)mask);
+    TOGGLE(PORT_K, PIN_K, (uint8_t)(mask>>8));
+    ATOMIC_END
+    NOTIFY(bank);
+    return;
+  }
+  PortBits m = toPorts(mask);
+  ATOMIC_BEGIN
+  TOGGLE(PORT_A, PIN_A, m.a);
+  TOGGLE(PORT_C, PIN_C, m.c);
+  TOGGLE(PORT_D, PIN_D, m.d);
+  TOGGLE(PORT_G, PIN_G, m.g);
+  ATOMIC_END
+  NOTIFY(bank);
+}
+
+uint16_t pinBankLatch(uint8_t bank) {
+  if (bank) return PORT_F | (uint16_t)PORT_K<<8;
+  return fromPorts(PORT_A, PORT_C, PORT_D, PORT_G);
+}
+
+uint16_t pinBankRead(uint8_t bank) {
+  SAMPLE(bank);
+  if (bank) return PIN_F | (uint16_t)PIN_K<<8;
+  return fromPorts(PIN_A, PIN_C, PIN_D, PIN_G);
+}
+
+#if defined(__AVR__)
+// PINx register and bit of a socket pin, per the wiring table in PinBank.h.
+static void locate(uint8_t bank, uint8_t pin, volatile uint8_t *&reg, uint8_t &bit) {
+  if (bank)         { reg=pin<8 ? &PINF : &PINK; bit=1<<(pin&7); }
+  else if (pin<4)   { reg=&PINA; bit=1<<(2*pin); }
+  else if (pin<12)  { reg=&PINC; bit=0x80>>(pin-4); }
+  else if (pin==12) { reg=&PIND; bit=0x80; }
+  else              { reg=&PING; bit=0x04>>(pin-13); }
+}
+
+uint16_t pinBankTimeEdge(uint8_t bank, uint16_t toggleMask, uint8_t watchPin) {
+  if (!TCCR5B) { TCCR5A=0; TCCR5B=_BV(CS50); }   // free running, clk/1
+  volatile uint8_t *reg;
+  uint8_t bit;
+  locate(bank, watchPin, reg, bit);
+  PortBits m = toPorts(toggleMask);
+  uint16_t t;
+  ATOMIC_BEGIN
+  uint8_t before = *reg & bit;
+  uint16_t t0 = TCNT5;
+  if (bank) { PINF = toggleMask; PINK = toggleMask>>8; }
+  else { PINA = m.a; PINC = m.c; PIND = m.d; PING = m.g; }
+  do {
+    t = TCNT5 - t0;
+    if ((*reg & bit) != before) break;
+  } while (t < PIN_BANK_TIMEOUT);
+  ATOMIC_END
+  return t < PIN_BANK_TIMEOUT ? t : PIN_BANK_TIMEOUT;
+}
+#else
+// Polls in virtual time, one microsecond (16 cycles) per sample.
+uint16_t pinBankTimeEdge(uint8_t bank, uint16_t toggleMask, uint8_t watchPin) {
+  uint16_t before = pinBankRead(bank) & (1u<<watchPin);
+  pinBankToggle(bank, toggleMask);
+  for (uint16_t t = 0; t < PIN_BANK_TIMEOUT; t += 16) {
+    if ((pinBankRead(bank) & (1u<<watchPin)) != before) return t;
+    delayMicroseconds(1);
+  }
+  return PIN_BANK_TIMEOUT;
+}
+
+void mockPinBankSetExternal(uint8_t bank, uint16_t word) {
+  if (bank) {
+    mockPort[4].ext = word; mockPort[5].ext = word>>8;
+    return;
+  }
+  PortBits e = toPorts(word);
+  mockPort[0].ext = e.a; mockPort[1].ext = e.c;
+  mockPort[2].ext = e.d; mockPort[3].ext = e.g;
+}
+
+uint16_t mockPinBankExternal(uint8_t bank) {
+  if (bank) return mockPort[4].ext | (uint16_t)mockPort[5].ext<<8;
+  return fromPorts(mockPort[0].ext, mockPort[1].ext, mockPort[2].ext, mockPort[3].ext);
+}
+
+static MockPort *mockPortNamed(char port) {
+  static const char names[] = "ACDGFK";
+  const char *n = port ? strchr(names, port) : nullptr;
+  return n ? &mockPort[n - names] : nullptr;
+}
+
+uint8_t mockPinBankPort(char port) {
+  MockPort *p = mockPortNamed(port);
+  return p ? p->port : 0;
+}
+
+uint8_t mockPinBankDdr(char port) {
+  MockPort *p = mockPortNamed(port);
+  return p ? p->ddr : 0;
+}
+#endif
@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include "Scheduler.h"
+
+static bool apply(JobKind kind, SchedSlot &s) {
+  return kind==JOB_SWEEP ? sweepApply(s.sweep) : vecApply(s.vec);
+}
+
+static void check(JobKind kind, SchedSlot &s) {
+  if (kind==JOB_SWEEP) sweepCheck(s.sweep, s.result);
+  else vecCheck(s.vec);
+}
+
+unsigned long schedRun(JobKind kind, SchedSlot *slots, uint8_t n) {
+  const uint8_t settle = kind==JOB_SWEEP ? SWEEP_SETTLE_US : VEC_SETTLE_US;
+  unsigned long appliedAt[SOCKET_COUNT], waited=0, t0=micros();
+  uint8_t busy=0;
+  if (n>SOCKET_COUNT) n=SOCKET_COUNT;
+  for (uint8_t i=0; i<n; i++) {
+    SchedSlot &s=slots[i];
+    Socket &k=*s.socket;
+    if (kind==JOB_SWEEP) s.ok=sweepBegin(s.sweep, k.ic, k.bank, k.ic.inputMask, s.result);
+    else { vecBegin(s.vec, k.ic, k.bank, k.ic.inputMask, s.passMap); s.ok=true; }
+    s.us=0;
+    if (s.ok && apply(kind, s)) { appliedAt[i]=micros(); busy|=1<<i; }
+  }
+  while (busy) {
+    for (uint8_t i=0; i<n; i++) {
+      if (!(busy & (1<<i))) continue;
+      SchedSlot &s=slots[i];
+      unsigned long since=micros()-appliedAt[i];
+      if (since<settle) { delayMicroseconds(settle-since); waited+=settle-since; }
+      check(kind, s);
+      if (apply(kind, s)) appliedAt[i]=micros();
+      else { busy&=~(1<<i); s.us=micros()-t0; }
+    }
+  }
+  return waited;
+}
@@ -0,0 +1,43 @@
+#include <Arduino.h>
+#include "Socket.h"
+#include "ClockGen.h"
+
+Socket sockets[SOCKET_COUNT];
+
+void socketsBegin() {
+  for (uint8_t i=0; i<SOCKET_COUNT; i++) {
+    memset(&sockets[i], 0, sizeof(Socket));
+    sockets[i].bank=i;
+  }
+}
+
+// ClockGen numbers channels in attach order, so every loaded socket's clocks
+// are attached again whenever one of them changes.
+static void attachClocks() {
+  clockReset();
+  for (uint8_t i=0; i<SOCKET_COUNT; i++) {
+    Socket &s=sockets[i];
+    s.clockFirst=clockChannels();
+    s.clockCount=0;
+    if (!s.loaded) continue;
+    for (uint8_t p=0; p<TOTAL_PINS; p++) {
+      if (!(s.ic.clockMask & (1u<<p))) continue;
+      if (clockAttach(s.bank, p)<0) break;
+      s.clockCount++;
+    }
+  }
+  clockStop();
+}
+
+void socketConfigure(Socket &s) {
+  pinBankWrite(s.bank, s.ic.vccMask);
+  pinBankSetDirection(s.bank, s.ic.activeMask & ~s.ic.outputMask);
+  s.inputCount=0;
+  for (uint8_t i=0; i<TOTAL_PINS && s.inputCount<8; i++)
+    if (s.ic.inputMask & (1u<<i)) s.inputPins[s.inputCount++]=i;
+  attachClocks();
+}
+
+uint8_t socketClockMask(const Socket &s) {
+  return ((1u<<s.clockCount)-1)<<s.clockFirst;
+}
@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include "Sweep.h"
+#include "BehaviorModel.h"
+#include "PinBank.h"
+
+enum SweepPhase : uint8_t { PH_START, PH_VECTOR, PH_CLOCK_HIGH, PH_CLOCK_LOW };
+
+bool sweepBegin(SweepJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+                SweepResult &r) {
+  memset(&r, 0, sizeof(r));
+  bool model = ic.model!=MODEL_NONE;
+  j.ic = &ic;
+  j.bank = bank;
+  j.phase = PH_START;
+  j.tests = nullptr;
+  j.inMask  = model ? ic.inputMask : gateInputMask(ic);
+  j.clkMask = model ? ic.clockMask : 0;
+  j.outMask = checkedOutputMask(ic);
+  if ((!ic.gateCount && !model) || (j.inMask & ~drivenMask)) return false;
+
+  // Gray-code bit k toggles socket pin order[k].
+  uint8_t n=0;
+  for (uint8_t i=0; i<TOTAL_PINS; i++) if (j.inMask & (1u<<i)) j.order[n++]=i;
+  j.step = 0;
+  j.total = 1ul<<n;
+  j.word = 0;
+  modelReset(j.st);
+  return true;
+}
+
+bool testBegin(SweepJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+               SweepResult &r) {
+  int8_t index = findProfile(ic.name);
+  if (index<0 || ic.model!=MODEL_NONE || !sweepBegin(j, ic, bank, drivenMask, r)) return false;
+  ICTestSet t;
+  loadTestSet(index, t);
+  if (!t.count) return false;
+  j.tests = IC_TEST_WORDS + t.first;
+  j.total = t.count;
+  return true;
+}
+
+bool sweepApply(SweepJob &j) {
+  const ICProfile &ic = *j.ic;
+  if (j.phase==PH_START) {
+    // All-zero start asserts the active-low clears of the sequential parts, so
+    // the chip and the model agree on the register contents from vector 0.
+    j.word = j.tests ? pgm_read_word(j.tests) : 0;
+    pinBankWrite(j.bank, j.word, j.inMask|j.clkMask);
+    modelStep(ic, j.st, 0, j.word);
+    j.applied = j.word;
+    j.phase = PH_VECTOR;
+  } else if (j.phase==PH_VECTOR && j.clkMask) {
+    // Full clock pulse after every vector, checked on both edges.
+    j.applied = j.word|j.clkMask;
+    pinBankWrite(j.bank, j.clkMask, j.clkMask);
+    modelStep(ic, j.st, j.word, j.applied);
+    j.phase = PH_CLOCK_HIGH;
+  } else if (j.phase==PH_CLOCK_HIGH) {
+    j.applied = j.word;
+    pinBankWrite(j.bank, 0, j.clkMask);
+    modelStep(ic, j.st, j.word|j.clkMask, j.word);
+    j.phase = PH_CLOCK_LOW;
+  } else {
+    if (++j.step==j.total) {
+      pinBankWrite(j.bank, 0, j.inMask|j.clkMask);
+      return false;
+    }
+    uint16_t prev = j.word;
+    if (j.tests) {
+      j.word = pgm_read_word(j.tests + j.step);
+      pinBankWrite(j.bank, j.word, j.inMask);
+    } else {
+      uint16_t b = 1u<<j.order[__builtin_ctzl(j.step)];
+      j.word ^= b;
+      pinBankToggle(j.bank, b);
+    }
+    j.applied = j.word;
+    modelStep(ic, j.st, prev, j.word);
+    j.phase = PH_VECTOR;
+  }
+  j.expected = expectedOutputs(ic, j.st, j.applied);
+  return true;
+}
+
+void sweepCheck(SweepJob &j, SweepResult &r) {
+  const ICProfile &ic = *j.ic;
+  uint16_t got = pinBankRead(j.bank) & j.outMask;
+  r.vectors++;
+  if (got==j.expected) return;
+  r.failures++;
+  for (uint8_t g=0; g<ic.gateCount; g++)
+    if ((got^j.expected) & (1u<<(ic.gates[g].output-1))) r.gateFailMask |= 1<<g;
+  if (r.logged<SWEEP_LOG_SIZE) r.log[r.logged++] = {j.applied, j.expected, got};
+}
+
+static void runJob(SweepJob &j, SweepResult &r) {
+  while (sweepApply(j)) {
+    delayMicroseconds(SWEEP_SETTLE_US);
+    sweepCheck(j, r);
+  }
+}
+
+bool runSweep(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, SweepResult &r) {
+  SweepJob j;
+  if (!sweepBegin(j, ic, bank, drivenMask, r)) return false;
+  runJob(j, r);
+  return true;
+}
+
+bool runTestSet(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, SweepResult &r) {
+  SweepJob j;
+  if (!testBegin(j, ic, bank, drivenMask, r)) return false;
+  runJob(j, r);
+  return true;
+}
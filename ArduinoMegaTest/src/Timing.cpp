@@ -0,0 +1,73 @@
+#include <Arduino.h>
+#include "Timing.h"
+#include "PinBank.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+static uint16_t ticksToNs(uint32_t t) {
+  uint32_t ns = t*1000/(F_CPU/1000000UL);
+  return ns>0xFFFF ? 0xFFFF : ns;
+}
+
+// Picks the first input k and setting of the others for which toggling k
+// flips the gate. Returns the input index or -1 (constant gate).
+static int8_t sensitize(const LogicGate &g, uint16_t &word) {
+  for (uint8_t k=0; k<g.inputCount; k++) {
+    uint16_t kBit = 1u<<(g.inputs[k]-1);
+    for (uint8_t c=0; c < (1<<g.inputCount); c++) {
+      uint16_t w = word;
+      for (uint8_t j=0; j<g.inputCount; j++) {
+        uint16_t b = 1u<<(g.inputs[j]-1);
+        w = (c & (1<<j)) ? w|b : w&~b;
+      }
+      w &= ~kBit;
+      if (evaluateGate(g, w) != evaluateGate(g, w|kBit)) { word = w; return k; }
+    }
+  }
+  return -1;
+}
+
+bool measureTiming(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, uint16_t reps,
+                   GateTiming *out) {
+  if (!ic.gateCount || (gateInputMask(ic) & ~drivenMask)) return false;
+  for (uint8_t i=0; i<ic.gateCount; i++) {
+    const LogicGate &g = ic.gates[i];
+    GateTiming &r = out[i];
+    memset(&r, 0, sizeof(r));
+    uint16_t word = pinBankLatch(bank);
+    int8_t k = sensitize(g, word);
+    if (k<0) { r.timeouts = reps; continue; }
+    uint8_t inPin = g.inputs[k]-1, outPin = g.output-1;
+    uint16_t toggle = 1u<<inPin;
+    pinBankWrite(bank, word, drivenMask);
+    delayMicroseconds(10);
+
+    // Instrumentation latency: the driven pin seen on its own PIN register.
+    uint16_t base = PIN_BANK_TIMEOUT;
+    for (uint8_t n=0; n<8; n++) {
+      uint16_t t = pinBankTimeEdge(bank, toggle, inPin);
+      if (t<base) base = t;
+    }
+
+    uint32_t sum = 0;
+    uint16_t lo = 0xFFFF, hi = 0, good = 0;
+    for (uint16_t n=0; n<reps; n++) {
+      uint16_t t = pinBankTimeEdge(bank, toggle, outPin);
+      delayMicroseconds(2);
+      if (t>=PIN_BANK_TIMEOUT) { r.timeouts++; continue; }
+      t = t>base ? t-base : 0;
+      sum += t; good++;
+      if (t<lo) lo = t;
+      if (t>hi) hi = t;
+    }
+    r.input = inPin+1;
+    if (good) {
+      r.minNs = ticksToNs(lo);
+      r.maxNs = ticksToNs(hi);
+      r.avgNs = ticksToNs((sum + good/2)/good);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+#include <Arduino.h>
+#include "Vectors.h"
+#include "PinBank.h"
+
+static TestVector table[VEC_MAX];
+static uint8_t count=0;
+
+void vecClear(uint8_t keep) { if (keep<count) count=keep; }
+
+bool vecAdd(const TestVector &v) {
+  if (count==VEC_MAX) return false;
+  table[count++]=v;
+  return true;
+}
+
+uint8_t vecCount() { return count; }
+
+void vecBegin(VecJob &j, const ICProfile &ic, uint8_t bank, uint16_t drivenMask,
+              uint8_t *passMap) {
+  j.ic=&ic;
+  j.bank=bank;
+  j.next=0;
+  j.passed=0;
+  j.apply=drivenMask | ic.clockMask;
+  j.passMap=passMap;
+  memset(passMap, 0, (count+7)/8);
+}
+
+bool vecApply(VecJob &j) {
+  if (j.next==count) return false;
+  const TestVector &v=table[j.next++];
+  pinBankWrite(j.bank, v.input, j.apply);
+  for (uint8_t c=0; c<v.clocks; c++) {
+    pinBankToggle(j.bank, j.ic->clockMask);
+    pinBankToggle(j.bank, j.ic->clockMask);
+  }
+  return true;
+}
+
+void vecCheck(VecJob &j) {
+  uint8_t i=j.next-1;
+  const TestVector &v=table[i];
+  uint16_t check=j.ic->outputMask & ~v.dontCare;
+  if (!((pinBankRead(j.bank) ^ v.expect) & check)) {
+    j.passMap[i/8] |= 1<<(i%8);
+    j.passed++;
+  }
+}
+
+uint8_t vecRun(const ICProfile &ic, uint8_t bank, uint16_t drivenMask, uint8_t *passMap) {
+  VecJob j;
+  vecBegin(j, ic, bank, drivenMask, passMap);
+  while (vecApply(j)) {
+    delayMicroseconds(VEC_SETTLE_US);
+    vecCheck(j);
+  }
+  return j.passed;
+}
@@ -0,0 +1,136 @@
+#if !defined(__AVR__)
+#include <Arduino.h>
+#include "VirtualDUT.h"
+#include "BehaviorModel.h"
+#include "PinBank.h"
+
+struct VirtualDUT {
+  bool       present;
+  ICProfile  ic;
+  ModelState st;
+  uint16_t   seen;          // pin levels as the chip last saw them
+  uint16_t   out;           // outputs it drives now
+  uint16_t   next;          // outputs it will drive once the delay is over
+  bool       pending;
+  uint64_t   dueNs;
+  uint32_t   delayNs;
+  Fault      fault;
+};
+
+static VirtualDUT duts[PIN_BANKS];
+
+static uint64_t nowNs() { return (uint64_t)micros()*1000; }
+
+// Levels on the pins: what the tester drives, else what the chip drives,
+// else nothing (low), with the fault applied.
+static uint16_t pinLevels(const VirtualDUT &d, uint8_t bank) {
+  uint16_t dir=pinBankDirection(bank), out=d.out & d.ic.outputMask;
+  const Fault &f=d.fault;
+  uint16_t p=1u<<f.pin, o=1u<<f.other;
+  if (f.kind==FAULT_OPEN) out&=~p;
+  uint16_t v=(pinBankLatch(bank) & dir) | (out & ~dir);
+  switch (f.kind) {
+    case FAULT_STUCK0: return v & ~p;
+    case FAULT_STUCK1: return v | p;
+    case FAULT_BRIDGE: return (v & p) && (v & o) ? v : v & ~(p|o);
+    default:           return v;
+  }
+}
+
+// Levels as the chip sees them; an input nobody drives floats high.
+static uint16_t chipView(const VirtualDUT &d, uint8_t bank) {
+  uint16_t dir=pinBankDirection(bank);
+  uint16_t v=pinLevels(d, bank) | ~(dir | d.ic.outputMask);
+  if (d.fault.kind==FAULT_OPEN) v|=1u<<d.fault.pin;
+  return v;
+}
+
+static void publish(const VirtualDUT &d, uint8_t bank) {
+  mockPinBankSetExternal(bank, pinLevels(d, bank) & ~pinBankDirection(bank));
+}
+
+// Feeds what the chip sees through the model; a bridge from an output back
+// to an input can take a few rounds to settle.
+static void update(uint8_t bank) {
+  VirtualDUT &d=duts[bank];
+  if (!d.present) return;
+  for (uint8_t round=0; round<4; round++) {
+    uint16_t view=chipView(d, bank);
+    if (view==d.seen) break;
+    modelStep(d.ic, d.st, d.seen, view);
+    d.seen=view;
+    uint16_t outs=expectedOutputs(d.ic, d.st, view);
+    if (!d.delayNs) { d.out=outs; d.pending=false; continue; }
+    if (outs==(d.pending ? d.next : d.out)) continue;
+    d.next=outs;
+    d.pending=true;
+    d.dueNs=nowNs()+d.delayNs;
+  }
+  publish(d, bank);
+}
+
+static void sample(uint8_t bank) {
+  VirtualDUT &d=duts[bank];
+  if (!d.present || !d.pending || nowNs()<d.dueNs) return;
+  d.out=d.next;
+  d.pending=false;
+  update(bank);
+}
+
+void vdutInsert(uint8_t bank, const ICProfile &ic) {
+  VirtualDUT &d=duts[bank];
+  uint32_t delayNs=d.delayNs;               // the delay belongs to the socket
+  memset(&d, 0, sizeof(d));
+  d.delayNs=delayNs;
+  d.ic=ic;
+  d.present=true;
+  modelReset(d.st);
+  mockPinBankHook=update;
+  mockPinBankSampleHook=sample;
+  // Powers up with its outputs already valid.
+  d.seen=chipView(d, bank);
+  d.out=expectedOutputs(d.ic, d.st, d.seen);
+  update(bank);
+}
+
+void vdutRemove(uint8_t bank) {
+  duts[bank].present=false;
+  mockPinBankSetExternal(bank, 0);
+}
+
+bool vdutPresent(uint8_t bank) { return duts[bank].present; }
+
+void vdutSetDelay(uint8_t bank, uint32_t ns) { duts[bank].delayNs=ns; }
+
+void vdutSetFault(uint8_t bank, const Fault &f) {
+  duts[bank].fault=f;
+  update(bank);
+}
+
+const char *faultName(FaultKind kind) {
+  switch (kind) {
+    case FAULT_STUCK0: return "STUCK0";
+    case FAULT_STUCK1: return "STUCK1";
+    case FAULT_BRIDGE: return "BRIDGE";
+    case FAULT_OPEN:   return "OPEN";
+    default:           return "NONE";
+  }
+}
+
+uint16_t vdutFaultList(const ICProfile &ic, Fault *out, uint16_t max) {
+  uint16_t signal=ic.activeMask & ~(ic.vccMask|ic.gndMask), n=0;
+  int8_t prev=-1;
+  for (uint8_t i=0; i<TOTAL_PINS; i++) {
+    if (!(signal & (1u<<i))) continue;
+    Fault f[4]={{FAULT_STUCK0, i, 0}, {FAULT_STUCK1, i, 0}, {FAULT_OPEN, i, 0}, {FAULT_BRIDGE, (uint8_t)prev, i}};
+    for (uint8_t k=0; k<4; k++) {
+      if (k==2 && !((ic.inputMask|ic.clockMask) & (1u<<i))) continue;
+      if (k==3 && prev<0) continue;
+      if (n<max) out[n]=f[k];
+      n++;
+    }
+    prev=i;
+  }
+  return n;
+}
+#endif
@@ -1,382 +1,1075 @@
 #include <Arduino.h>
-#include <FastLED.h>
+#include <PinReporter.h>
+#include <Telemetry.h>
+#include <TesterFrame.h>
+#include "Buttons.h"
+#include "Capture.h"
+#include "ClockGen.h"
+#include "ICDatabase.h"
+#include "Identify.h"
+#include "LedRender.h"
+#include "NextionLink.h"
+#include "PinBank.h"
+#include "Scheduler.h"
+#include "Socket.h"
+#include "Sweep.h"
+#include "Timing.h"
+#include "Vectors.h"
+#include "VirtualDUT.h"
 
 // Forward declarations
 void configurePins();
 uint8_t activePinCount();
 void setInputPins(const String &bits);
 void handleICSelection(const String &name);
+void handleIdentify(const String &cmd);
 void handlePinData(const String &pinData);
 void handleStatusRequest();
+void handleStats(const String &cmd);
+void handleSweep();
+void handleTest();
+void handleSweepAll();
+void handleSocket(const String &cmd);
+void handleTiming(const String &cmd);
+void handleSim(const String &cmd);
+void handleVectors(const String &cmd);
+void runVectors();
+void runVectorsAll();
 void processNextionMessage(const String &msg);
 void handleNextion();
-void updateLEDs();
 String getPinStates();
 void setInputPins(const String &bits);
 void handleSerial();
+void handleCommand(const String &cmd);
+void handleFrame(const Frame &f);
+void sendPinsFrame(uint16_t word);
+static void sendFrame(uint8_t op, const uint8_t *payload, uint8_t len);
+void sendDeltaFrame(uint32_t ms, uint16_t changed, uint16_t word);
+void reportPins();
 void handleButtons();
-void setupClockPin();
 void generateClockPulse();
+void handleClockCommand(const String &cmd);
+void reportClock();
+void handleCapture(const String &cmd);
+void streamCapture();
 void mapClockToButton();
+void sendToNextion(const String &cmd);
+void showPins(const String &bits);
+uint16_t bitsToWord(const String &bits);
+String wordToBits(uint16_t word);
+uint16_t packActive(uint16_t word);
+uint16_t unpackActive(uint16_t packed);
 
-// Constants
-const uint8_t TOTAL_PINS = 16;
-const uint8_t IC_PINS[TOTAL_PINS] = {22, 24, 26, 28, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41};
-const uint8_t BUTTON_PINS[8]   = {2, 3, 4, 5, 6, 7, 8, 9};
-#define LEDS_PER_STRIP 3
-#define NUM_STRIPS 3
-#define LED_PIN_STRIP1 10
-#define LED_PIN_STRIP2 11
-#define LED_PIN_STRIP3 12
-static CRGB strip1[LEDS_PER_STRIP];
-static CRGB strip2[LEDS_PER_STRIP];
-static CRGB strip3[LEDS_PER_STRIP];
-
-// Gate types
-enum GateType { AND, OR, NAND, NOR, XOR, XNOR, NOT };
-
-// Structures
-struct LogicGate {
-  GateType type;
-  uint8_t  inputs[4];
-  uint8_t  inputCount;
-  uint8_t  output;
-};
-struct ICPinConfig {
-  uint8_t     number;
-  const char *role;
-  bool        isActiveLow;
-};
-struct ICProfile {
-  const char *name;
-  ICPinConfig pins[TOTAL_PINS];
-  LogicGate   gates[8];
-  uint8_t     gateCount;
-};
+Socket *sel = &sockets[0];               // socket the commands, buttons and display act on
+ICProfile *currentIC = nullptr;          // &sel->ic while it holds a part
+bool binaryMode = false;                 // USB link speaks TesterFrame frames
+FrameParser frameRx;
+PinReporter reporter;                    // change-driven PINS/PD stream to the host
+LoopHistogram loopTimes;                 // for STATS
+LinkCounters usbLink;                    // received only; replies go out from everywhere
 
-// IC database
-ICProfile IC_DB[] = {
-  // Existing ICs...
-  {"7432", {{1,"INPUT",0},{2,"INPUT",0},{3,"OUTPUT",0},{4,"INPUT",0},
-            {5,"INPUT",0},{6,"OUTPUT",0},{7,"GND",0},{8,"NC",0},
-            {9,"NC",0},{10,"OUTPUT",0},{11,"INPUT",0},{12,"INPUT",0},
-            {13,"OUTPUT",0},{14,"INPUT",0},{15,"INPUT",0},{16,"VCC",0}},
-           {{OR,{2,3},2,1},{OR,{5,6},2,4},{OR,{11,10},2,12},{OR,{14,13},2,15}},4},
-  {"7404", {{1,"INPUT",0},{2,"OUTPUT",0},{3,"INPUT",0},{4,"OUTPUT",0},
-            {5,"INPUT",0},{6,"OUTPUT",0},{7,"GND",0},{8,"NC",0},
-            {9,"NC",0},{10,"OUTPUT",0},{11,"INPUT",0},{12,"OUTPUT",0},
-            {13,"INPUT",0},{14,"INPUT",0},{15,"OUTPUT",0},{16,"VCC",0}},
-           {{NOT,{1},1,2},{NOT,{3},1,4},{NOT,{5},1,6},
-            {NOT,{11},1,10},{NOT,{14},1,15},{NOT,{13},1,12}},6},
-  {"7400", {{1,"INPUT",0},{2,"INPUT",0},{3,"OUTPUT",0},{4,"INPUT",0},
-            {5,"INPUT",0},{6,"OUTPUT",0},{7,"GND",0},{8,"NC",0},
-            {9,"NC",0},{10,"OUTPUT",0},{11,"INPUT",0},{12,"INPUT",0},
-            {13,"OUTPUT",0},{14,"INPUT",0},{15,"INPUT",0},{16,"VCC",0}},
-           {{NAND,{1,2},2,3},{NAND,{4,5},2,6},{NAND,{11,10},2,13},{NAND,{14,15},2,12}},4},
-  {"7408", {{1,"INPUT",0},{2,"INPUT",0},{3,"OUTPUT",0},{4,"INPUT",0},
-            {5,"INPUT",0},{6,"OUTPUT",0},{7,"GND",0},{8,"NC",0},
-            {9,"NC",0},{10,"OUTPUT",0},{11,"INPUT",0},{12,"INPUT",0},
-            {13,"OUTPUT",0},{14,"INPUT",0},{15,"INPUT",0},{16,"VCC",0}},
-           {{AND,{1,2},2,3},{AND,{4,5},2,6},{AND,{11,10},2,13},{AND,{14,15},2,12}},4},
-  {"7486", {{1,"INPUT",0},{2,"INPUT",0},{3,"OUTPUT",0},{4,"INPUT",0},
-            {5,"INPUT",0},{6,"OUTPUT",0},{7,"GND",0},{8,"NC",0},
-            {9,"NC",0},{10,"OUTPUT",0},{11,"INPUT",0},{12,"INPUT",0},
-            {13,"OUTPUT",0},{14,"INPUT",0},{15,"INPUT",0},{16,"VCC",0}},
-           {{XOR,{1,2},2,3},{XOR,{4,5},2,6},{XOR,{11,10},2,13},{XOR,{14,15},2,12}},4},
-  // New ICs:
-  {"194",   {{1,"RESET",0},{2,"DSR",0},{3,"D0",0},{4,"D1",0},
-             {5,"D2",0},{6,"D3",0},{7,"DSL",0},{8,"GND",0},
-             {9,"S0",0},{10,"S1",0},{11,"CLOCK",0},{12,"Q3",0},
-             {13,"Q2",0},{14,"Q1",0},{15,"Q0",0},{16,"VCC",0}}, {},0},
-  {"7402",  {{1,"OUTPUT",0},{2,"INPUT",0},{3,"INPUT",0},{4,"OUTPUT",0},
-             {5,"INPUT",0},{6,"INPUT",0},{7,"GND",0},{8,"NC",0},
-             {9,"NC",0},{10,"INPUT",0},{11,"OUTPUT",0},{12,"INPUT",0},
-             {13,"INPUT",0},{14,"VCC",0},{15,"NC",0},{16,"NC",0}},
-            {{NOR,{2,3},2,1},{NOR,{5,6},2,4},{NOR,{12,13},2,11},{NOR,{10,9},2,8}},4},
-  {"7485",  {{1,"B3",0},{2,"IA<B",0},{3,"IA=B",0},{4,"IA>B",0},
-             {5,"OA>B",0},{6,"OA=B",0},{7,"OA<B",0},{8,"GND",0},
-             {9,"B0",0},{10,"A0",0},{11,"B1",0},{12,"A1",0},
-             {13,"A2",0},{14,"B2",0},{15,"A3",0},{16,"VCC",0}}, {},0},
-  {"7473",  {{1,"CLK1",0},{2,"RST1",0},{3,"K1",0},{4,"VCC",0},
-             {5,"CLK2",0},{6,"RST2",0},{7,"J2",0},{8,"Q2N",0},
-             {9,"Q2",0},{10,"K2",0},{11,"GND",0},{12,"Q1",0},
-             {13,"Q1N",0},{14,"J1",0},{15,"NC",0},{16,"NC",0}}, {},0},
-  {"74139", {{1,"1E",0},{2,"1A0",0},{3,"1A1",0},{4,"1Y0",0},
-             {5,"1Y1",0},{6,"1Y2",0},{7,"1Y3",0},{8,"GND",0},
-             {9,"2Y3",0},{10,"2Y2",0},{11,"2Y1",0},{12,"2Y0",0},
-             {13,"2A1",0},{14,"2A0",0},{15,"2E",0},{16,"VCC",0}}, {},0},
-  {"74157", {{1,"SEL",0},{2,"1A",0},{3,"1B",0},{4,"1Y",0},
-             {5,"2A",0},{6,"2B",0},{7,"2Y",0},{8,"GND",0},
-             {9,"3Y",0},{10,"3B",0},{11,"3A",0},{12,"4Y",0},
-             {13,"4B",0},{14,"4A",0},{15,"ENABLE",0},{16,"VCC",0}}, {},0}
+// Text written while a binary-mode frame is handled goes back framed
+// (TesterFrame.h): one OP_CMD frame per line, a longer line split over full
+// frames and ended by a shorter (possibly empty) one.
+class FrameReply : public Print {
+ public:
+  using Print::write;
+  size_t write(uint8_t c) override {
+    if (c=='\r') return 1;
+    if (c=='\n') { endLine(); return 1; }
+    if (len==FRAME_MAX_PAYLOAD) { sendFrame(OP_CMD, buf, len); len=0; }
+    buf[len++]=c;
+    return 1;
+  }
+  void finish() { if (len) endLine(); }
+ private:
+  uint8_t buf[FRAME_MAX_PAYLOAD], len=0;
+  void endLine() {
+    sendFrame(OP_CMD, buf, len);
+    if (len==FRAME_MAX_PAYLOAD) sendFrame(OP_CMD, buf, 0);
+    len=0;
+  }
 };
 
-ICProfile *currentIC = nullptr;
-bool lastButtonStates[8] = {false};
-uint8_t inputPinMapping[8], inputPinCount = 0;
-bool clockState = false;
-uint8_t clockPin = 255;
+FrameReply frameReply;
+Print *console = &Serial;                // replies: Serial, or frameReply inside handleFrame()
 
 void setup() {
   Serial.begin(115200);
-  Serial3.begin(9600, SERIAL_8N1);
-  Serial3.setTimeout(50);
-  Serial.println("IC Logic Tester with Nextion Display Ready");
-  for (auto b: BUTTON_PINS) pinMode(b, INPUT_PULLUP);
-  for (auto p: IC_PINS)     pinMode(p, INPUT);
-  FastLED.addLeds<WS2812, LED_PIN_STRIP1, GRB>(strip1, LEDS_PER_STRIP);
-  FastLED.addLeds<WS2812, LED_PIN_STRIP2, GRB>(strip2, LEDS_PER_STRIP);
-  FastLED.addLeds<WS2812, LED_PIN_STRIP3, GRB>(strip3, LEDS_PER_STRIP);
-  fill_solid(strip1, LEDS_PER_STRIP, CRGB::Black);
-  fill_solid(strip2, LEDS_PER_STRIP, CRGB::Black);
-  fill_solid(strip3, LEDS_PER_STRIP, CRGB::Black);
-  FastLED.show();
-  for (int i=0; i<3; i++) {
-    sendToNextion("t0.txt=\"IC Tester Ready\"");
-    delay(100);
-  }
-  Serial.println("Setup complete!");
+  unsigned long baud=nextionBegin(NEXTION_TARGET_BAUD);
+  console->print("NEXTION:BAUD:"); console->println(baud ? String(baud) : String("NO_REPLY"));
+  console->println("IC Logic Tester with Nextion Display Ready");
+  buttonsBegin();
+  pinBankBegin();
+  socketsBegin();
+  clockBegin();
+  captureBegin();
+  ledBegin();
+  nextionShow("t0.txt=\"IC Tester Ready\"");
+  console->println("Setup complete!");
 }
 
 void loop() {
+  unsigned long t0=micros();
   handleSerial();
   handleNextion();
+  buttonService();
   handleButtons();
-  if (currentIC && millis() % 200 < 2) {
-    String states = getPinStates();
-    Serial.print("PINS:"); Serial.println(states);
-    sendToNextion("PINS:" + states);
-    sendToNextion("IcVisualiser.t1.txt=\"" + states + "\"");
-    updateLEDs();
+  nextionService();
+  clockService();
+  reportClock();
+  captureService();
+  streamCapture();
+  if (currentIC) reportPins();
+  // Moves whenever a byte arrives, consumed or not
+  ledService(usbLink.rxBytes+nextionLink.rxBytes+Serial.available()+NEXTION_SERIAL.available());
+  loopTimes.record(micros()-t0);
+}
+
+// --- Pin Reporting ---
+// Changes go out as "PD:<ms>:<changed>:<value>" (hex, bit j = pin string char
+// j) as soon as they are seen; a full PINS line is the heartbeat.
+void reportPins() {
+  ReportKind kind=reporter.poll(pinBankRead(sel->bank) & currentIC->activeMask, millis());
+  if (kind==REPORT_NONE) return;
+  uint16_t word=reporter.value();
+  if (kind==REPORT_FULL) {
+    if (binaryMode) sendPinsFrame(word);
+    else { console->print("PINS:"); console->println(wordToBits(word)); }
+  } else if (binaryMode) {
+    sendDeltaFrame(reporter.stamp(), reporter.changed(), word);
+  } else {
+    console->print("PD:"); console->print(reporter.stamp());
+    console->print(':'); console->print(packActive(reporter.changed()), HEX);
+    console->print(':'); console->println(packActive(word), HEX);
   }
+  String states=wordToBits(word);
+  showPins(states);
+  ledUpdate(word);
 }
 
 // --- Configuration & Helpers ---
 void configurePins() {
   if (!currentIC) return;
-  for (uint8_t i=0; i<TOTAL_PINS; i++) {
-    const char *r = currentIC->pins[i].role;
-    if (!strcmp(r,"NC"))      pinMode(IC_PINS[i], INPUT);
-    else if (!strcmp(r,"VCC")){pinMode(IC_PINS[i], OUTPUT); digitalWrite(IC_PINS[i], HIGH);}
-    else if (!strcmp(r,"GND")){pinMode(IC_PINS[i], OUTPUT); digitalWrite(IC_PINS[i], LOW);}
-    else if (!strcmp(r,"INPUT")) {pinMode(IC_PINS[i], OUTPUT); digitalWrite(IC_PINS[i], LOW);}
-    else if (!strcmp(r,"OUTPUT")) pinMode(IC_PINS[i], INPUT);
-    else if (!strcmp(r,"CLOCK")||!strcmp(r,"CLK1")||!strcmp(r,"CLK2"))
-      {pinMode(IC_PINS[i], OUTPUT); digitalWrite(IC_PINS[i], LOW);}
-    else pinMode(IC_PINS[i], OUTPUT), digitalWrite(IC_PINS[i], LOW);
-  }
-  setupClockPin();
+  socketConfigure(*sel);
+  ledMap(currentIC->outputMask);
   mapClockToButton();
-  setupInputMapping();
-  Serial.print("INFO:Configured "); Serial.print(currentIC->name);
-  Serial.print(" ("); Serial.print(activePinCount()); Serial.println(" pins)");
+  console->print("INFO:Configured "); console->print(currentIC->name);
+  console->print(" ("); console->print(activePinCount()); console->println(" pins)");
 }
 
 uint8_t activePinCount() {
-  if (!currentIC) return 0;
-  uint8_t n=0;
-  for (auto &p: currentIC->pins) if (strcmp(p.role,"NC")) n++;
-  return n;
+  return currentIC ? currentIC->activePins : 0;
 }
 
-void setupInputMapping() {
-  inputPinCount=0;
-  if (!currentIC) return;
-  for (uint8_t i=0; i<TOTAL_PINS && inputPinCount<8; i++)
-    if (!strcmp(currentIC->pins[i].role,"INPUT"))
-      inputPinMapping[inputPinCount++]=i;
+// Pin strings carry one char per non-NC pin, in socket order.
+uint16_t bitsToWord(const String &bits) {
+  uint16_t w=0;
+  for (uint8_t i=0,j=0; i<TOTAL_PINS; i++) {
+    if (!(currentIC->activeMask & (1u<<i))) continue;
+    if (bits.charAt(j++)=='1') w |= 1u<<i;
+  }
+  return w;
 }
 
-String getPinStates() {
+String wordToBits(uint16_t word) {
   String s;
   for (uint8_t i=0; i<TOTAL_PINS; i++)
-    if (strcmp(currentIC->pins[i].role,"NC"))
-      s += digitalRead(IC_PINS[i]) ? '1':'0';
+    if (currentIC->activeMask & (1u<<i)) s += (word & (1u<<i)) ? '1':'0';
   return s;
 }
 
-void setInputPins(const String &bits) {
-  if (!currentIC || bits.length()!=activePinCount()) return;
-  for (uint8_t i=0,j=0;i<TOTAL_PINS;i++) {
-    if (strcmp(currentIC->pins[i].role,"NC")==0) continue;
-    if (!strcmp(currentIC->pins[i].role,"INPUT")) {
-      digitalWrite(IC_PINS[i], bits.charAt(j)=='1');
-    }
+// Binary PINS payloads pack the same pin string one bit per char.
+uint16_t packActive(uint16_t word) {
+  uint16_t p=0;
+  for (uint8_t i=0,j=0; i<TOTAL_PINS; i++) {
+    if (!(currentIC->activeMask & (1u<<i))) continue;
+    if (word & (1u<<i)) p |= 1u<<j;
     j++;
   }
+  return p;
 }
 
-// --- Clock Functions ---
-void setupClockPin() {
-  clockPin=255;
-  if (!currentIC) return;
-  for (uint8_t i=0;i<TOTAL_PINS;i++) {
-    const char *r = currentIC->pins[i].role;
-    if (!strcmp(r,"CLOCK")||!strcmp(r,"CLK1")||!strcmp(r,"CLK2")) {
-      clockPin=i;
-      pinMode(IC_PINS[i], OUTPUT);
-      digitalWrite(IC_PINS[i], LOW);
-      break;
-    }
+uint16_t unpackActive(uint16_t packed) {
+  uint16_t w=0;
+  for (uint8_t i=0,j=0; i<TOTAL_PINS; i++) {
+    if (!(currentIC->activeMask & (1u<<i))) continue;
+    if (packed & (1u<<j)) w |= 1u<<i;
+    j++;
   }
+  return w;
+}
+
+String getPinStates() {
+  return wordToBits(pinBankRead(sel->bank));
+}
+
+void setInputPins(const String &bits) {
+  if (!currentIC || bits.length()!=activePinCount()) return;
+  pinBankWrite(sel->bank, bitsToWord(bits), currentIC->inputMask);
 }
 
+// --- Clock Functions ---
+// Every clock pin of the part gets its own ClockGen channel (see Socket.h),
+// numbered from 1 in socket order on the CLOCK: commands.
+#define CLOCK_PULSE_HZ 10000
+
+// One full pulse on every clock channel of the socket at once; returns after
+// the falling edge. Whatever CLOCK:SET configured is kept for CLOCK:START.
 void generateClockPulse() {
-  if (clockPin==255||!currentIC) return;
-  digitalWrite(IC_PINS[clockPin], LOW);
-  delayMicroseconds(10);
-  digitalWrite(IC_PINS[clockPin], HIGH);
-  delayMicroseconds(10);
-  digitalWrite(IC_PINS[clockPin], LOW);
-  Serial.println("CLOCK:PULSE_GENERATED");
+  if (!sel->clockCount||!currentIC) return;
+  uint8_t m=socketClockMask(*sel);
+  clockPulse(m, CLOCK_PULSE_HZ);
+  while (clockBusy(m)) { delayMicroseconds(10); clockService(); }
+  console->println("CLOCK:PULSE_GENERATED");
   sendToNextion("CLOCK:PULSED");
 }
 
+static String field(const String &s, uint8_t n) {
+  int from=0;
+  while (n--) { from=s.indexOf(':', from)+1; if (!from) return ""; }
+  int to=s.indexOf(':', from);
+  return to<0 ? s.substring(from) : s.substring(from, to);
+}
+
+// CLOCK:PULSE                              single pulse on all channels
+// CLOCK:FREQ:<hz>                          all channels free running, 0 stops
+// CLOCK:SET:<ch>:<hz>[:<edges>[:<phase>]]  arm a channel (edges 0 = free)
+// CLOCK:SAMPLE:<ch>:<R|F|N>                latch pins after that edge
+// CLOCK:START / CLOCK:STOP
+void handleClockCommand(const String &cmd) {
+  String op=field(cmd, 1);
+  uint8_t first=sel->clockFirst, mask=socketClockMask(*sel);
+  if (!sel->clockCount) { console->println("ERR:NO_CLOCK"); return; }
+  if (op=="PULSE") {
+    generateClockPulse();
+  } else if (op=="FREQ") {
+    float hz=field(cmd, 2).toFloat();
+    if (hz==0) { clockStop(mask); console->println("OK:CLOCK"); return; }
+    for (uint8_t c=0;c<sel->clockCount;c++)
+      if (!clockConfigure(first+c, hz, 0, 0)) { console->println("ERR:INVALID_FREQUENCY"); return; }
+    clockStart(mask);
+    console->println("OK:CLOCK");
+  } else if (op=="SET" || op=="SAMPLE") {
+    int c=field(cmd, 2).toInt()-1;
+    if (c<0 || c>=sel->clockCount) { console->println("ERR:INVALID_CHANNEL"); return; }
+    c+=first;
+    if (op=="SAMPLE") {
+      char e=field(cmd, 3).charAt(0);
+      clockSampleOn(c, e=='R' ? EDGE_RISING : e=='F' ? EDGE_FALLING : EDGE_NONE);
+    } else if (!clockConfigure(c, field(cmd, 3).toFloat(), field(cmd, 4).toInt(), field(cmd, 5).toInt())) {
+      console->println("ERR:INVALID_FREQUENCY"); return;
+    }
+    console->println("OK:CLOCK");
+  } else if (op=="START") {
+    clockStart(mask);
+    console->println("OK:CLOCK");
+  } else if (op=="STOP") {
+    clockStop(mask);
+    console->println("OK:CLOCK");
+  } else {
+    console->println("ERR:INVALID_CMD");
+  }
+}
+
+// Edge samples go out as CLOCK:SAMPLE:<hex>,... (pin string bits), and the
+// end of a burst as CLOCK:DONE with the edge count of each channel.
+void reportClock() {
+  static bool wasBusy=false;
+  uint16_t w;
+  uint8_t n=0;
+  while (n<8 && clockReadSample(w)) {
+    console->print(n++ ? "," : "CLOCK:SAMPLE:");
+    console->print(currentIC ? packActive(w) : w, HEX);
+  }
+  if (n) console->println();
+  bool busy=clockBusy(socketClockMask(*sel));
+  if (wasBusy && !busy) {
+    console->print("CLOCK:DONE:");
+    for (uint8_t c=0;c<sel->clockCount;c++) {
+      if (c) console->print(',');
+      console->print(clockEdgeCount(sel->clockFirst+c));
+    }
+    console->println();
+  }
+  wasBusy=busy;
+}
+
 void mapClockToButton() {
-  if (clockPin!=255 && currentIC) {
-    Serial.print("INFO:Clock mapped to button 8 (Pin ");
-    Serial.print(clockPin+1); Serial.println(")");
+  if (sel->clockCount && currentIC) {
+    console->print("INFO:Clock mapped to button 8 (Pin ");
+    console->print(clockChannelPin(sel->clockFirst)+1); console->println(")");
+  }
+}
+
+// --- Capture ---
+// CAPTURE:<hz>[:<pre>[:<mask>:<value>]] arms the analyzer; mask and value
+// are hex over the pin string bits. A finished record streams as
+//   CAP:BEGIN:<hz>:<samples>:<trigger index>
+//   CAP:<value>x<count>,...        (OP_CAPTURE frames in binary mode)
+//   CAP:END:<runs>
+// one line per loop pass, only while the USB TX buffer has room for it.
+#define CAP_RUNS_PER_LINE 4
+#define CAP_LINE_ROOM     48
+
+void handleCapture(const String &cmd) {
+  if (field(cmd, 1)=="STOP") { captureStop(); console->println("OK:CAPTURE"); return; }
+  uint32_t hz=field(cmd, 1).toInt();
+  uint16_t pre=field(cmd, 2).length() ? field(cmd, 2).toInt() : CAPTURE_DEPTH/4;
+  uint16_t mask=strtoul(field(cmd, 3).c_str(), nullptr, 16);
+  uint16_t value=strtoul(field(cmd, 4).c_str(), nullptr, 16);
+  if (currentIC) { mask=unpackActive(mask); value=unpackActive(value); }
+  if (!captureStart(sel->bank, hz, pre, mask, value)) { console->println("ERR:INVALID_CAPTURE"); return; }
+  console->println("OK:CAPTURE");
+}
+
+void streamCapture() {
+  static bool begun=false;
+  static uint16_t runVal=0, runLen=0, runs=0;
+  if (captureState()!=CAP_DONE || Serial.availableForWrite()<CAP_LINE_ROOM) return;
+  if (!begun) {
+    console->print("CAP:BEGIN:"); console->print(captureRate());
+    console->print(':'); console->print(captureLength());
+    console->print(':'); console->println(captureTriggerIndex());
+    begun=true; runLen=0; runs=0;
+    return;
+  }
+  uint16_t val[CAP_RUNS_PER_LINE], len[CAP_RUNS_PER_LINE], w;
+  uint8_t n=0;
+  bool end=false;
+  while (n<CAP_RUNS_PER_LINE) {
+    if (!captureRead(w)) {
+      end=true;
+      if (runLen) { val[n]=runVal; len[n++]=runLen; runLen=0; }
+      break;
+    }
+    if (currentIC) w=packActive(w);
+    if (runLen && w==runVal) { runLen++; continue; }
+    if (runLen) { val[n]=runVal; len[n++]=runLen; }
+    runVal=w; runLen=1;
+  }
+  if (n && binaryMode) {
+    uint8_t p[CAP_RUNS_PER_LINE*4];
+    for (uint8_t i=0;i<n;i++) {
+      p[4*i]=val[i]; p[4*i+1]=val[i]>>8; p[4*i+2]=len[i]; p[4*i+3]=len[i]>>8;
+    }
+    sendFrame(OP_CAPTURE, p, 4*n);
+  } else if (n) {
+    console->print("CAP:");
+    for (uint8_t i=0;i<n;i++) {
+      if (i) console->print(',');
+      console->print(val[i], HEX); console->print('x'); console->print(len[i]);
+    }
+    console->println();
+  }
+  runs+=n;
+  if (end && !runLen) {
+    console->print("CAP:END:"); console->println(runs);
+    captureRelease();
+    begun=false;
   }
 }
 
 // --- Communication & Handling ---
+// Events; component state goes through nextionShow() and its cache.
 void sendToNextion(const String &cmd) {
-  while (Serial3.available()) Serial3.read();
-  Serial3.print(cmd);
-  Serial3.write(0xFF); Serial3.write(0xFF); Serial3.write(0xFF);
-  delay(10);
+  nextionQueue(cmd);
+}
+
+// Pin string for both the display's PINS handler and the visualiser, sent
+// only when it changed.
+void showPins(const String &bits) {
+  nextionShow("PINS:"+bits);
+  nextionShow("IcVisualiser.t1.txt=\""+bits+"\"");
 }
 
 void handleICSelection(const String &name) {
   currentIC=nullptr;
-  for (auto &ic:IC_DB) if (name==ic.name) { currentIC=&ic; break; }
+  sel->loaded=false;
+  int8_t idx=findProfile(name.c_str());
+  if (idx>=0) { loadProfile(idx, sel->ic); sel->loaded=true; currentIC=&sel->ic; }
   if (currentIC) {
     configurePins();
-    Serial.println("IC:"+name);
-    sendToNextion("t0.txt=\""+name+"\"");
+    reporter.force();
+    vecClear();
+    console->println("IC:"+name);
+    nextionShow("t0.txt=\""+name+"\"");
+  } else {
+    console->println("ERROR: IC not found - "+name);
+  }
+}
+
+// IDENTIFY[:<part>] finds which profile sharing <part>'s pinout (default:
+// the selected IC, else the first IC_DB entry) is in the socket and selects
+// it. Answers IDENTIFY:<name>, IDENTIFY:UNKNOWN or IDENTIFY:AMBIGUOUS:<a>,<b>
+// followed by :V=<vectors>:T=<us>us.
+void handleIdentify(const String &cmd) {
+  String refName=field(cmd, 1);
+  ICProfile ref;
+  if (refName.length()) {
+    int8_t idx=findProfile(refName.c_str());
+    if (idx<0) { console->println("ERROR: IC not found - "+refName); return; }
+    loadProfile(idx, ref);
+  } else if (currentIC) {
+    ref=*currentIC;
   } else {
-    Serial.println("ERROR: IC not found - "+name);
+    loadProfile(0, ref);
   }
+  if (!ref.gateCount) { console->println("ERR:NO_GATES"); return; }
+  clockStop(socketClockMask(*sel));
+  sel->ic=ref; sel->loaded=true;          // power the socket for this pinout
+  currentIC=&sel->ic;
+  configurePins();
+  IdentifyResult r;
+  unsigned long t0=micros();
+  identifyPart(ref, sel->bank, r);
+  unsigned long us=micros()-t0;
+  ICProfile p;
+  if (r.index>=0) {
+    loadProfile(r.index, p);
+    console->print("IDENTIFY:"); console->print(p.name);
+  } else if (!r.remaining) {
+    console->print("IDENTIFY:UNKNOWN");
+  } else {
+    console->print("IDENTIFY:AMBIGUOUS");
+    char sep=':';
+    for (uint8_t i=0;i<IC_DB_COUNT && i<IDENTIFY_MAX_PARTS;i++) {
+      if (!(r.remaining & (1UL<<i))) continue;
+      loadProfile(i, p);
+      console->print(sep); console->print(p.name); sep=',';
+    }
+  }
+  console->print(":V="); console->print(r.vectors);
+  console->print(":T="); console->print(us); console->println("us");
+  if (r.index>=0) { loadProfile(r.index, p); handleICSelection(p.name); }
 }
 
 void handlePinData(const String &pinData) {
   if (!currentIC || pinData.length()!=activePinCount()) return;
   setInputPins(pinData);
-  Serial.println("PINS:"+pinData);
-  sendToNextion("IcVisualiser.t1.txt=\""+pinData+"\"");
+  console->println("PINS:"+pinData);
+  nextionShow("IcVisualiser.t1.txt=\""+pinData+"\"");
 }
 
 void handleStatusRequest() {
-  if (!currentIC) sendToNextion("t0.txt=\"No IC Selected\"");
+  if (!currentIC) nextionShow("t0.txt=\"No IC Selected\"");
   else {
     String st="IC:"+String(currentIC->name)+" Pins:"+String(activePinCount())+" Gates:"+String(currentIC->gateCount);
-    Serial.println("STATUS:"+st);
+    console->println("STATUS:"+st);
+  }
+}
+
+static int freeMemory() {
+#if defined(__AVR__)
+  extern char __heap_start, *__brkval;
+  char top;
+  return &top - (__brkval ? __brkval : &__heap_start);
+#else
+  return 0;
+#endif
+}
+
+// STATS:UP=<ms>
+// STATS:LOOP:<n0>,...,<n5>:MAX=<us>      (buckets <64,<256,<1024,<4096,<16384 us, longer)
+// STATS:USB:RX=<bytes>/<msgs>
+// STATS:NEXTION:RX=<bytes>/<lines>:TX=<bytes>/<cmds>:Q=<pending>/<slots>:DROP=<n>:COALESCE=<n>:SKIP=<n>:BAUD=<rate>
+// STATS:CLOCK:LOST=<samples>
+// STATS:BUTTON:LOST=<presses/releases dropped on a full queue>
+// STATS:LED:FRAMES=<strip writes>:DEFER=<waits for a quiet link>
+// STATS:HEAP=<free bytes>
+// STATS:DONE
+// STATS:CLEAR zeroes the histogram and link counters.
+void handleStats(const String &cmd) {
+  if (cmd=="STATS:CLEAR") {
+    loopTimes.clear(); usbLink.clear(); nextionLink.clear();
+    console->println("OK:STATS");
+    return;
+  }
+  char buf[64];
+  console->print("STATS:UP="); console->println(millis());
+  loopTimes.format(buf, sizeof(buf));
+  console->print("STATS:LOOP:"); console->println(buf);
+  console->print("STATS:USB:RX="); console->print(usbLink.rxBytes);
+  console->print('/'); console->println(usbLink.rxMsgs);
+  nextionLink.format(buf, sizeof(buf));
+  console->print("STATS:NEXTION:"); console->print(buf);
+  console->print(":Q="); console->print(nextionPending()); console->print('/'); console->print(NEXTION_SLOTS);
+  console->print(":DROP="); console->print(nextionDropped);
+  console->print(":COALESCE="); console->print(nextionCoalesced);
+  console->print(":SKIP="); console->print(nextionCache.suppressed);
+  console->print(":BAUD="); console->println(nextionBaud());
+  console->print("STATS:CLOCK:LOST="); console->println(clockSamplesLost());
+  console->print("STATS:BUTTON:LOST="); console->println(buttonEventsLost());
+  console->print("STATS:LED:FRAMES="); console->print(ledFrames);
+  console->print(":DEFER="); console->println(ledDeferrals);
+  console->print("STATS:HEAP="); console->println(freeMemory());
+  console->println("STATS:DONE");
+}
+
+static void printHex4(uint16_t v) {
+  for (int8_t sh=12; sh>=0; sh-=4) console->print((v>>sh)&0xF, HEX);
+}
+
+// "PASS:<vectors>" or "FAIL:<failed>/<vectors>:G=<gate mask>:<in>><exp>/<got>,..."
+static void printSweep(const SweepResult &r) {
+  if (!r.failures) {
+    console->print("PASS:"); console->print(r.vectors);
+  } else {
+    console->print("FAIL:"); console->print(r.failures);
+    console->print('/'); console->print(r.vectors);
+    console->print(":G="); console->print(r.gateFailMask, HEX);
+    for (uint8_t i=0;i<r.logged;i++) {
+      console->print(i?',':':');
+      printHex4(r.log[i].input); console->print('>');
+      printHex4(r.log[i].expected); console->print('/');
+      printHex4(r.log[i].actual);
+    }
+    if (r.failures>r.logged) console->print(",...");
+  }
+}
+
+// SWEEP:PASS:<vectors>:T=<us>us
+// SWEEP:FAIL:<failed>/<vectors>:G=<gate mask>:<in>><exp>/<got>,...:T=<us>us
+// Vectors are hex pin words (bit i = socket pin i+1); only failures are listed.
+// TEST answers the same way, prefixed TEST:, after running only the part's
+// structural test set (ERR:NO_TEST_SET for parts without gates).
+static void runCheck(bool testSet) {
+  if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
+  clockStop(socketClockMask(*sel));       // the sweep drives the clock pins itself
+  uint16_t held=pinBankLatch(sel->bank) & currentIC->inputMask;
+  SweepResult r;
+  unsigned long t0=micros();
+  bool ok=testSet ? runTestSet(*currentIC, sel->bank, currentIC->inputMask, r)
+                  : runSweep(*currentIC, sel->bank, currentIC->inputMask, r);
+  unsigned long us=micros()-t0;
+  pinBankWrite(sel->bank, held, currentIC->inputMask);
+  if (!ok) { console->println(testSet ? "ERR:NO_TEST_SET" : "ERR:NO_TEST_MODEL"); return; }
+  console->print(testSet ? "TEST:" : "SWEEP:");
+  printSweep(r);
+  console->print(":T="); console->print(us); console->println("us");
+  nextionShow("t0.txt=\""+String(currentIC->name)+(r.failures?" FAIL\"":" PASS\""));
+}
+
+void handleSweep() { runCheck(false); }
+void handleTest()  { runCheck(true); }
+
+// Loaded sockets into slots; clocks stopped and the held inputs saved.
+static uint8_t gatherSockets(SchedSlot *slots, uint16_t *held, uint16_t extra) {
+  uint8_t n=0;
+  for (uint8_t i=0;i<SOCKET_COUNT;i++) {
+    Socket &k=sockets[i];
+    if (!k.loaded) continue;
+    clockStop(socketClockMask(k));
+    held[n]=pinBankLatch(k.bank) & (k.ic.inputMask | (extra & k.ic.clockMask));
+    slots[n++].socket=&k;
+  }
+  return n;
+}
+
+static void restoreSockets(SchedSlot *slots, uint16_t *held, uint8_t n, uint16_t extra) {
+  for (uint8_t i=0;i<n;i++) {
+    Socket &k=*slots[i].socket;
+    pinBankWrite(k.bank, held[i], k.ic.inputMask | (extra & k.ic.clockMask));
+  }
+}
+
+// SWEEP:ALL sweeps every loaded socket at once, interleaved by the scheduler:
+//   SWEEP:S<n>:PASS:...:T=<us>us  or  SWEEP:S<n>:ERR:NO_TEST_MODEL  per socket
+//   SWEEP:DONE:<sockets>:T=<us>us:WAIT=<us spent waiting for settles>us
+void handleSweepAll() {
+  SchedSlot slots[SOCKET_COUNT];
+  uint16_t held[SOCKET_COUNT];
+  uint8_t n=gatherSockets(slots, held, 0);
+  if (!n) { console->println("ERR:NO_IC_SELECTED"); return; }
+  unsigned long t0=micros();
+  unsigned long waited=schedRun(JOB_SWEEP, slots, n);
+  unsigned long us=micros()-t0;
+  restoreSockets(slots, held, n, 0);
+  for (uint8_t i=0;i<n;i++) {
+    console->print("SWEEP:S"); console->print(slots[i].socket->bank+1); console->print(':');
+    if (!slots[i].ok) { console->println("ERR:NO_TEST_MODEL"); continue; }
+    printSweep(slots[i].result);
+    console->print(":T="); console->print(slots[i].us); console->println("us");
+  }
+  console->print("SWEEP:DONE:"); console->print(n);
+  console->print(":T="); console->print(us);
+  console->print("us:WAIT="); console->print(waited); console->println("us");
+}
+
+// TIMING[:<reps>] - propagation delay of every gate, one line per gate:
+//   TIMING:G<n>:P<in>>P<out>:<min>/<avg>/<max>ns[:TO=<timeouts>]
+void handleTiming(const String &cmd) {
+  if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
+  long reps=field(cmd, 1).length() ? field(cmd, 1).toInt() : TIMING_REPS;
+  if (reps<1 || reps>1000) { console->println("ERR:INVALID_REPS"); return; }
+  clockStop(socketClockMask(*sel));
+  uint16_t held=pinBankLatch(sel->bank) & currentIC->inputMask;
+  GateTiming t[8];
+  bool ok=measureTiming(*currentIC, sel->bank, currentIC->inputMask, reps, t);
+  pinBankWrite(sel->bank, held, currentIC->inputMask);
+  if (!ok) { console->println("ERR:NO_GATES"); return; }
+  for (uint8_t g=0; g<currentIC->gateCount; g++) {
+    console->print("TIMING:G"); console->print(g+1);
+    console->print(":P"); console->print(t[g].input);
+    console->print(">P"); console->print(currentIC->gates[g].output);
+    console->print(':'); console->print(t[g].minNs);
+    console->print('/'); console->print(t[g].avgNs);
+    console->print('/'); console->print(t[g].maxNs); console->print("ns");
+    if (t[g].timeouts) { console->print(":TO="); console->print(t[g].timeouts); }
+    console->println();
+  }
+  console->print("TIMING:DONE:"); console->println(reps);
+}
+
+#if !defined(__AVR__)
+// --- Virtual DUT (native builds, see VirtualDUT.h) ---
+// SIM:INSERT[:<part>]  virtual chip (default: the selected IC) into the selected socket
+// SIM:REMOVE
+// SIM:DELAY:<ns>       propagation delay
+// SIM:FAULT:NONE | STUCK0:<pin> | STUCK1:<pin> | OPEN:<pin> | BRIDGE:<pin>:<pin>
+//                      pins are socket pins; all answer OK:SIM
+// SIM:CAMPAIGN[:TEST] puts a virtual copy of the selected IC in its socket and
+// sweeps it (or runs its structural test set) under every single fault of
+// the chip:
+//   SIM:ESCAPE:<kind>:<pin>[:<pin>]    each fault the sweep did not see
+//   SIM:CLASS:<kind>:<caught>/<faults> per fault class
+//   SIM:COVERAGE:<caught>/<faults>:T=<virtual us>us
+static void simCampaign(bool testSet) {
+  if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
+  vdutInsert(sel->bank, *currentIC);
+  Fault faults[64];
+  uint16_t n=vdutFaultList(*currentIC, faults, 64);
+  if (n>64) n=64;
+  uint16_t caught[FAULT_OPEN+1]={0}, total[FAULT_OPEN+1]={0}, all=0;
+  clockStop(socketClockMask(*sel));
+  uint16_t held=pinBankLatch(sel->bank) & currentIC->inputMask;
+  unsigned long t0=micros();
+  for (uint16_t i=0; i<n; i++) {
+    const Fault &f=faults[i];
+    SweepResult r;
+    vdutSetFault(sel->bank, f);
+    bool ok=testSet ? runTestSet(*currentIC, sel->bank, currentIC->inputMask, r)
+                    : runSweep(*currentIC, sel->bank, currentIC->inputMask, r);
+    if (!ok) { console->println(testSet ? "ERR:NO_TEST_SET" : "ERR:NO_TEST_MODEL"); break; }
+    total[f.kind]++;
+    if (r.failures) { caught[f.kind]++; all++; continue; }
+    console->print("SIM:ESCAPE:"); console->print(faultName(f.kind));
+    console->print(':'); console->print(f.pin+1);
+    if (f.kind==FAULT_BRIDGE) { console->print(':'); console->print(f.other+1); }
+    console->println();
+  }
+  unsigned long us=micros()-t0;
+  vdutSetFault(sel->bank, {FAULT_NONE, 0, 0});
+  pinBankWrite(sel->bank, held, currentIC->inputMask);
+  for (uint8_t k=FAULT_STUCK0; k<=FAULT_OPEN; k++) {
+    if (!total[k]) continue;
+    console->print("SIM:CLASS:"); console->print(faultName((FaultKind)k));
+    console->print(':'); console->print(caught[k]); console->print('/'); console->println(total[k]);
+  }
+  console->print("SIM:COVERAGE:"); console->print(all); console->print('/'); console->print(n);
+  console->print(":T="); console->print(us); console->println("us");
+}
+
+void handleSim(const String &cmd) {
+  String op=field(cmd, 1);
+  if (op=="CAMPAIGN") { simCampaign(field(cmd, 2)=="TEST"); return; }
+  if (op=="INSERT") {
+    ICProfile ic;
+    String part=field(cmd, 2);
+    if (part.length()) {
+      int8_t idx=findProfile(part.c_str());
+      if (idx<0) { console->println("ERROR: IC not found - "+part); return; }
+      loadProfile(idx, ic);
+    } else if (currentIC) {
+      ic=*currentIC;
+    } else {
+      console->println("ERR:NO_IC_SELECTED"); return;
+    }
+    vdutInsert(sel->bank, ic);
+  } else if (op=="REMOVE") {
+    vdutRemove(sel->bank);
+  } else if (op=="DELAY") {
+    vdutSetDelay(sel->bank, field(cmd, 2).toInt());
+  } else if (op=="FAULT") {
+    static const char *const kinds[]={"NONE", "STUCK0", "STUCK1", "BRIDGE", "OPEN"};
+    String kind=field(cmd, 2);
+    long a=field(cmd, 3).toInt(), b=field(cmd, 4).toInt();
+    uint8_t k=0;
+    while (k<=FAULT_OPEN && kind!=kinds[k]) k++;
+    if (k>FAULT_OPEN || (k!=FAULT_NONE && (a<1 || a>TOTAL_PINS)) ||
+        (k==FAULT_BRIDGE && (b<1 || b>TOTAL_PINS || b==a))) {
+      console->println("ERR:INVALID_SIM"); return;
+    }
+    Fault f={(FaultKind)k, (uint8_t)(a ? a-1 : 0), (uint8_t)(b ? b-1 : 0)};
+    vdutSetFault(sel->bank, f);
+  } else {
+    console->println("ERR:INVALID_SIM"); return;
+  }
+  console->println("OK:SIM");
+}
+#endif
+
+// --- Test Vectors ---
+// VEC:CLEAR
+// VEC:ADD:<in>,<expect>,<dontcare>,<clocks>[;<in>,...]   words in hex over
+//         the pin string bits, as PD lines; answers OK:VEC:<count>
+// VEC:RUN answers VEC:RESULT:<n>:<passed>:<pass bitmap>:T=<us>us, bitmap
+//         as hex bytes, byte 0 (vectors 0-7, bit i = vector i) first.
+void handleVectors(const String &cmd) {
+  String op=field(cmd, 1);
+  if (op=="CLEAR") {
+    vecClear();
+    console->println("OK:VEC:0");
+  } else if (op=="ADD") {
+    if (!cmd.startsWith("VEC:ADD:") || cmd.length()==8) { console->println("ERR:INVALID_VEC"); return; }
+    if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
+    uint8_t before=vecCount();
+    const char *p=cmd.c_str()+8;
+    while (*p) {
+      char *end;
+      TestVector v;
+      v.input=unpackActive(strtoul(p, &end, 16));
+      if (*end!=',') break;
+      v.expect=unpackActive(strtoul(end+1, &end, 16));
+      if (*end!=',') break;
+      v.dontCare=unpackActive(strtoul(end+1, &end, 16));
+      if (*end!=',') break;
+      v.clocks=strtoul(end+1, &end, 10);
+      if (!vecAdd(v)) { vecClear(before); console->println("ERR:VEC_FULL"); return; }
+      p=*end==';' ? end+1 : end;
+      if (*end && *end!=';') break;
+    }
+    if (*p) { vecClear(before); console->println("ERR:INVALID_VEC"); return; }
+    console->print("OK:VEC:"); console->println(vecCount());
+  } else if (op=="RUN") {
+    if (field(cmd, 2)=="ALL") runVectorsAll(); else runVectors();
+  } else {
+    console->println("ERR:INVALID_CMD");
+  }
+}
+
+static void printPassMap(const uint8_t *map, uint8_t bytes) {
+  for (uint8_t i=0;i<bytes;i++) {
+    if (map[i]<16) console->print('0');
+    console->print(map[i], HEX);
+  }
+}
+
+void runVectors() {
+  if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
+  clockStop(socketClockMask(*sel));
+  uint16_t held=pinBankLatch(sel->bank) & (currentIC->inputMask | currentIC->clockMask);
+  uint8_t map[VEC_MAX/8];
+  unsigned long t0=micros();
+  uint8_t passed=vecRun(*currentIC, sel->bank, currentIC->inputMask, map);
+  unsigned long us=micros()-t0;
+  pinBankWrite(sel->bank, held, currentIC->inputMask | currentIC->clockMask);
+  uint8_t n=vecCount(), bytes=(n+7)/8;
+  if (binaryMode) {
+    uint8_t p[2+VEC_MAX/8]={n, passed};
+    memcpy(p+2, map, bytes);
+    sendFrame(OP_VEC, p, 2+bytes);
+    return;
   }
+  console->print("VEC:RESULT:"); console->print(n);
+  console->print(':'); console->print(passed); console->print(':');
+  printPassMap(map, bytes);
+  console->print(":T="); console->print(us); console->println("us");
+}
+
+// VEC:RUN:ALL runs the table on every loaded socket at once (meant for a
+// batch of the same part):
+//   VEC:RESULT:S<n>:<count>:<passed>:<pass bitmap>:T=<us>us  per socket
+//   VEC:DONE:<sockets>:T=<us>us:WAIT=<us>us
+void runVectorsAll() {
+  SchedSlot slots[SOCKET_COUNT];
+  uint16_t held[SOCKET_COUNT];
+  uint8_t n=gatherSockets(slots, held, 0xFFFF);
+  if (!n) { console->println("ERR:NO_IC_SELECTED"); return; }
+  unsigned long t0=micros();
+  unsigned long waited=schedRun(JOB_VECTORS, slots, n);
+  unsigned long us=micros()-t0;
+  restoreSockets(slots, held, n, 0xFFFF);
+  uint8_t count=vecCount();
+  for (uint8_t i=0;i<n;i++) {
+    console->print("VEC:RESULT:S"); console->print(slots[i].socket->bank+1);
+    console->print(':'); console->print(count);
+    console->print(':'); console->print(slots[i].vec.passed); console->print(':');
+    printPassMap(slots[i].passMap, (count+7)/8);
+    console->print(":T="); console->print(slots[i].us); console->println("us");
+  }
+  console->print("VEC:DONE:"); console->print(n);
+  console->print(":T="); console->print(us);
+  console->print("us:WAIT="); console->print(waited); console->println("us");
+}
+
+// SOCKET:<n> selects the socket (1-based) that IC:, PINS:, CLOCK:, SWEEP,
+// the buttons and the display act on; answers SOCKET:<n>:<part or NONE>.
+// SOCKETS lists them: SOCKETS:<count>:SEL=<n>:<part or ->,...
+void handleSocket(const String &cmd) {
+  if (cmd=="SOCKETS") {
+    console->print("SOCKETS:"); console->print(SOCKET_COUNT);
+    console->print(":SEL="); console->print(sel->bank+1);
+    for (uint8_t i=0;i<SOCKET_COUNT;i++) {
+      console->print(i?',':':');
+      console->print(sockets[i].loaded ? sockets[i].ic.name : "-");
+    }
+    console->println();
+    return;
+  }
+  long n=field(cmd, 1).toInt();
+  if (n<1 || n>SOCKET_COUNT) { console->println("ERR:INVALID_SOCKET"); return; }
+  sel=&sockets[n-1];
+  currentIC=sel->loaded ? &sel->ic : nullptr;
+  ledMap(currentIC ? currentIC->outputMask : 0);
+  reporter.force();
+  console->print("SOCKET:"); console->print(n); console->print(':');
+  console->println(currentIC ? currentIC->name : "NONE");
+  nextionShow("t0.txt=\""+String(currentIC ? currentIC->name : "No IC Selected")+"\"");
 }
 
 void processNextionMessage(const String &msg) {
   if (msg.startsWith("IC:")) {
-    handleICSelection(msg.substring(3,7));
+    handleICSelection(msg.substring(3));
   } else if (msg.startsWith("PINS:")) {
     handlePinData(msg.substring(5));
   } else if (msg=="CLOCK:PULSE") {
-    Serial.println("CLOCK:PULSE received from Nextion");
+    console->println("CLOCK:PULSE received from Nextion");
     generateClockPulse();
+  } else if (msg.startsWith("CLOCK:")) {
+    handleClockCommand(msg);
   } else if (msg=="STATUS") {
     handleStatusRequest();
+  } else if (msg=="SWEEP") {
+    handleSweep();
+  } else if (msg=="IDENTIFY") {
+    handleIdentify(msg);
   }
 }
 
 void handleNextion() {
-  if (!Serial3.available()) return;
-  String raw=Serial3.readString();
-  String clean;
-  for (char c:raw) if ((c>=32&&c<=126)||c=='\n'||c=='\r') clean+=c;
-  int pos=0;
-  while (pos<clean.length()) {
-    int nl=clean.indexOf('\n',pos);
-    if (nl<0) nl=clean.length();
-    String line=clean.substring(pos,nl);
+  String line;
+  while (nextionReadLine(line)) {
     line.trim();
     if (line.length()) processNextionMessage(line);
-    pos=nl+1;
   }
 }
 
 void handleSerial() {
+  if (binaryMode) {
+    while (Serial.available()) {
+      usbLink.rxBytes++;
+      if (frameRx.feed(Serial.read())) { usbLink.rxMsgs++; handleFrame(frameRx.frame); }
+    }
+    return;
+  }
   if (!Serial.available()) return;
   String cmd=Serial.readStringUntil('\n');
+  usbLink.rx(cmd.length()+1);
   cmd.trim();
+  handleCommand(cmd);
+}
+
+void handleCommand(const String &cmd) {
   if (cmd.startsWith("IC:")) {
     handleICSelection(cmd.substring(3));
   } else if (cmd.startsWith("PINS:")) {
-    if (!currentIC) { Serial.println("ERR:NO_IC_SELECTED"); return; }
+    if (!currentIC) { console->println("ERR:NO_IC_SELECTED"); return; }
     String b=cmd.substring(5);
-    if (b.length()!=activePinCount()) { Serial.println("ERR:INVALID_PIN_LENGTH"); return; }
-    for (char c:b) if (c!='0'&&c!='1'){ Serial.println("ERR:INVALID_BINARY"); return; }
+    if (b.length()!=activePinCount()) { console->println("ERR:INVALID_PIN_LENGTH"); return; }
+    for (char c:b) if (c!='0'&&c!='1'){ console->println("ERR:INVALID_BINARY"); return; }
     setInputPins(b);
-    Serial.println("OK:PINS_SET");
-    sendToNextion("PINS:"+b);
-    sendToNextion("IcVisualiser.t1.txt=\""+b+"\"");
+    console->println("OK:PINS_SET");
+    showPins(b);
   } else if (cmd=="CLOCK:PULSE") {
-    Serial.println("CLOCK:PULSE received from PC");
+    console->println("CLOCK:PULSE received from PC");
     generateClockPulse();
+  } else if (cmd.startsWith("CLOCK:")) {
+    handleClockCommand(cmd);
+  } else if (cmd.startsWith("CAPTURE:")) {
+    handleCapture(cmd);
   } else if (cmd=="STATUS") {
     handleStatusRequest();
+  } else if (cmd=="STATS" || cmd=="STATS:CLEAR") {
+    handleStats(cmd);
+  } else if (cmd.startsWith("NEXTION:BAUD:")) {
+    // Renegotiate the display link, e.g. after swapping the display
+    unsigned long want=strtoul(cmd.c_str()+13, nullptr, 10);
+    if (!nextionValidBaud(want)) { console->println("ERR:INVALID_BAUD"); return; }
+    unsigned long baud=nextionBegin(want);
+    if (!baud) { console->println("ERR:NEXTION_NO_REPLY"); return; }
+    console->print("NEXTION:BAUD:"); console->println(baud);
+  } else if (cmd=="SWEEP") {
+    handleSweep();
+  } else if (cmd=="TEST") {
+    handleTest();
+  } else if (cmd=="SWEEP:ALL") {
+    handleSweepAll();
+  } else if (cmd=="SOCKETS" || cmd.startsWith("SOCKET:")) {
+    handleSocket(cmd);
+  } else if (cmd=="IDENTIFY" || cmd.startsWith("IDENTIFY:")) {
+    handleIdentify(cmd);
+  } else if (cmd.startsWith("VEC:")) {
+    handleVectors(cmd);
+  } else if (cmd=="TIMING" || cmd.startsWith("TIMING:")) {
+    handleTiming(cmd);
+#if !defined(__AVR__)
+  } else if (cmd.startsWith("SIM:")) {
+    handleSim(cmd);
+#endif
   } else if (cmd=="LIST") {
-    Serial.println("AVAILABLE_ICS:");
-    for (auto &ic:IC_DB) {
-      Serial.print(ic.name); Serial.print(" (");
-      ICProfile *tmp=currentIC; currentIC=(ICProfile*)&ic;
-      Serial.print(activePinCount()); Serial.println(" pins)");
-      currentIC=tmp;
+    console->println("AVAILABLE_ICS:");
+    for (uint8_t i=0;i<IC_DB_COUNT;i++) {
+      ICProfile p;
+      loadProfile(i, p);
+      console->print(p.name); console->print(" (");
+      console->print(p.activePins); console->println(" pins)");
     }
   } else if (cmd=="SYNC") {
-    Serial.println("SYNC:OK");
+    console->println("SYNC:OK");
+    reporter.force();
+  } else if (cmd.startsWith("REPORT:")) {
+    // REPORT:<min interval ms>,<heartbeat ms>
+    int comma=cmd.indexOf(',');
+    if (comma<0) { console->println("ERR:INVALID_REPORT"); return; }
+    reporter.minIntervalMs=cmd.substring(7,comma).toInt();
+    reporter.heartbeatMs=cmd.substring(comma+1).toInt();
+    console->println("OK:REPORT");
+  } else if (cmd=="BIN:ON") {
+    console->println("OK:BIN");
+    binaryMode=true;
+    frameRx.reset();
+    reporter.force();
   } else {
-    Serial.println("ERR:INVALID_CMD");
+    console->println("ERR:INVALID_CMD");
   }
 }
 
+// " @<settled>ms +<lag>ms": the tick a press settled on and how long it
+// waited in the queue.
+static void printPressTime(const ButtonEvent &e) {
+  console->print(" @");console->print(e.ms);
+  console->print("ms +");console->print(buttonTicks()-e.ms);console->println("ms");
+}
+
+// Debounced presses, oldest first (see Buttons.h); releases are ignored.
+// Toggles and clock pulses are applied in the order the presses settled, so
+// a pulse queued behind a toggle clocks the toggled level in.
 void handleButtons() {
-  static unsigned long lastDebounce=0;
-  if (millis()-lastDebounce<50) return;
-  bool changed=false;
-  for (uint8_t i=0;i<8;i++) {
-    bool now=!digitalRead(BUTTON_PINS[i]);
-    if (now!=lastButtonStates[i]) {
-      lastButtonStates[i]=now; changed=true;
-      if (now && currentIC) {
-        if (i==7 && clockPin!=255) {
-          generateClockPulse();
-        } else if (i<inputPinCount) {
-          uint8_t idx=inputPinMapping[i];
-          bool v=!digitalRead(IC_PINS[idx]);
-          digitalWrite(IC_PINS[idx], v);
-          Serial.print("BUTTON:");Serial.print(i+1);
-          Serial.print(" -> Pin ");Serial.print(idx+1);
-          Serial.print(" = ");Serial.println(v?"HIGH":"LOW");
-          String s=getPinStates();
-          sendToNextion("PINS:"+s);
-          sendToNextion("IcVisualiser.t1.txt=\""+s+"\"");
-        }
-      }
+  ButtonEvent e;
+  while (buttonRead(e)) {
+    if (!e.pressed || !currentIC) continue;
+    uint8_t i=e.button;
+    if (i==7 && sel->clockCount) {
+      console->print("BUTTON:8 -> CLOCK");printPressTime(e);
+      generateClockPulse();
+    } else if (i<sel->inputCount) {
+      uint8_t idx=sel->inputPins[i];
+      pinBankToggle(sel->bank, 1u<<idx);
+      bool v=pinBankLatch(sel->bank) & (1u<<idx);
+      console->print("BUTTON:");console->print(i+1);
+      console->print(" -> Pin ");console->print(idx+1);
+      console->print(" = ");console->print(v?"HIGH":"LOW");printPressTime(e);
+      String s=getPinStates();
+      showPins(s);
     }
   }
-  if (changed) lastDebounce=millis();
 }
 
-void updateLEDs() {
-  if (!currentIC) return;
-  fill_solid(strip1, LEDS_PER_STRIP, CRGB::Black);
-  fill_solid(strip2, LEDS_PER_STRIP, CRGB::Black);
-  fill_solid(strip3, LEDS_PER_STRIP, CRGB::Black);
-  for (uint8_t i=0;i<currentIC->gateCount;i++) {
-    bool st=digitalRead(IC_PINS[currentIC->gates[i].output-1]);
-    CRGB c=st?CRGB::Green:CRGB::Red;
-    if (i<LEDS_PER_STRIP) strip1[i]=c;
-    else if (i<2*LEDS_PER_STRIP) strip2[i-LEDS_PER_STRIP]=c;
-    else strip3[i-2*LEDS_PER_STRIP]=c;
-  }
-  FastLED.show();
+// --- Binary framing (TesterFrame) ---
+static void sendFrame(uint8_t op, const uint8_t *payload, uint8_t len) {
+  uint8_t buf[FRAME_MAX_PAYLOAD+FRAME_OVERHEAD];
+  Serial.write(buf, frameEncode(op, payload, len, buf));
+}
+
+static void sendAck(uint8_t op) { sendFrame(OP_ACK, &op, 1); }
+
+static void sendNak(uint8_t op, uint8_t err) {
+  uint8_t p[2]={op, err};
+  sendFrame(OP_NAK, p, 2);
+}
+
+void sendPinsFrame(uint16_t word) {
+  uint16_t packed=packActive(word);
+  uint8_t p[3]={activePinCount(), (uint8_t)packed, (uint8_t)(packed>>8)};
+  sendFrame(OP_PINS, p, 3);
+}
+
+void sendDeltaFrame(uint32_t ms, uint16_t changed, uint16_t word) {
+  uint16_t c=packActive(changed), v=packActive(word);
+  uint8_t p[8]={(uint8_t)ms, (uint8_t)(ms>>8), (uint8_t)(ms>>16), (uint8_t)(ms>>24),
+                (uint8_t)c, (uint8_t)(c>>8), (uint8_t)v, (uint8_t)(v>>8)};
+  sendFrame(OP_DELTA, p, 8);
+}
+
+void handleFrame(const Frame &f) {
+  console=&frameReply;
+  switch (f.op) {
+    case OP_SYNC:
+      sendAck(f.op);
+      reporter.force();
+      break;
+    case OP_IC: {
+      char name[FRAME_MAX_PAYLOAD+1];
+      memcpy(name, f.data, f.len); name[f.len]=0;
+      handleICSelection(name);
+      if (currentIC) sendAck(f.op); else sendNak(f.op, FERR_NOT_FOUND);
+      break;
+    }
+    case OP_PINS: {
+      if (!currentIC) { sendNak(f.op, FERR_NO_IC); break; }
+      if (f.len!=3 || f.data[0]!=activePinCount()) { sendNak(f.op, FERR_LENGTH); break; }
+      uint16_t word=unpackActive(f.data[1] | (uint16_t)f.data[2]<<8);
+      pinBankWrite(sel->bank, word, currentIC->inputMask);
+      sendAck(f.op);
+      String b=wordToBits(word);
+      showPins(b);
+      break;
+    }
+    case OP_VEC: {
+      if (!currentIC) { sendNak(f.op, FERR_NO_IC); break; }
+      if (!f.len || f.len%7) { sendNak(f.op, FERR_LENGTH); break; }
+      uint8_t before=vecCount();
+      bool full=false;
+      for (uint8_t i=0; i<f.len; i+=7) {
+        const uint8_t *d=f.data+i;
+        TestVector v={unpackActive(d[0] | d[1]<<8), unpackActive(d[2] | d[3]<<8),
+                      unpackActive(d[4] | d[5]<<8), d[6]};
+        if (!vecAdd(v)) { full=true; break; }
+      }
+      if (full) { vecClear(before); sendNak(f.op, FERR_FULL); } else sendAck(f.op);
+      break;
+    }
+    case OP_CLOCK:
+      generateClockPulse();
+      sendAck(f.op);
+      break;
+    case OP_STATUS: {
+      if (!currentIC) { sendNak(f.op, FERR_NO_IC); break; }
+      uint8_t p[FRAME_MAX_PAYLOAD];
+      p[0]=activePinCount(); p[1]=currentIC->gateCount;
+      uint8_t n=strlen(currentIC->name);
+      if (n>FRAME_MAX_PAYLOAD-2) n=FRAME_MAX_PAYLOAD-2;
+      memcpy(p+2, currentIC->name, n);
+      sendFrame(OP_STATUS, p, n+2);
+      break;
+    }
+    case OP_CMD: {
+      char cmd[FRAME_MAX_PAYLOAD+1];
+      memcpy(cmd, f.data, f.len); cmd[f.len]=0;
+      handleCommand(cmd);
+      frameReply.finish();
+      sendAck(f.op);
+      break;
+    }
+    case OP_EXIT:
+      sendAck(f.op);
+      binaryMode=false;
+      reporter.force();
+      break;
+    default:
+      sendNak(f.op, FERR_UNKNOWN_OP);
+  }
+  frameReply.finish();
+  console=&Serial;
 }
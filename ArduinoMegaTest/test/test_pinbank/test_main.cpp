@@ -0,0 +1,127 @@
+// Socket word <-> port register mapping of PinBank, against the RAM-backed
+// ports of the native build:  pio test -e native -f test_pinbank
+#include <stdio.h>
+#include <unity.h>
+#include "PinBank.h"
+
+// Port register and bit of each socket pin of bank 0 (wiring table in PinBank.h).
+struct Wire { char port; uint8_t bit; };
+static const Wire bank0[16] = {
+  {'A',0x01}, {'A',0x04}, {'A',0x10}, {'A',0x40},
+  {'C',0x80}, {'C',0x40}, {'C',0x20}, {'C',0x10},
+  {'C',0x08}, {'C',0x04}, {'C',0x02}, {'C',0x01},
+  {'D',0x80}, {'G',0x04}, {'G',0x02}, {'G',0x01},
+};
+
+// The PORTx bits a word should leave set, per port.
+static uint8_t expectedPort(char port, uint16_t word) {
+  uint8_t v = 0;
+  for (uint8_t i=0; i<16; i++)
+    if ((word>>i & 1) && bank0[i].port == port) v |= bank0[i].bit;
+  return v;
+}
+
+static void assertPorts(uint16_t word) {
+  char msg[32];
+  snprintf(msg, sizeof msg, "word 0x%04X", word);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(expectedPort('A', word), mockPinBankPort('A'), msg);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(expectedPort('C', word), mockPinBankPort('C'), msg);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(expectedPort('D', word), mockPinBankPort('D'), msg);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE(expectedPort('G', word), mockPinBankPort('G'), msg);
+}
+
+void setUp() {
+  pinBankBegin();
+  mockPinBankSetExternal(0, 0);
+  mockPinBankSetExternal(1, 0);
+}
+
+void tearDown() {}
+
+static void test_direction_mask() {
+  pinBankSetDirection(0, 0xFFFF);
+  TEST_ASSERT_EQUAL_HEX8(0x55, mockPinBankDdr('A'));
+  TEST_ASSERT_EQUAL_HEX8(0xFF, mockPinBankDdr('C'));
+  TEST_ASSERT_EQUAL_HEX8(0x80, mockPinBankDdr('D'));
+  TEST_ASSERT_EQUAL_HEX8(0x07, mockPinBankDdr('G'));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, pinBankDirection(0));
+
+  pinBankSetDirection(0, 0x100F);                        // pins 1-4 and 13
+  TEST_ASSERT_EQUAL_HEX8(0x55, mockPinBankDdr('A'));
+  TEST_ASSERT_EQUAL_HEX8(0x00, mockPinBankDdr('C'));
+  TEST_ASSERT_EQUAL_HEX8(0x80, mockPinBankDdr('D'));
+  TEST_ASSERT_EQUAL_HEX8(0x00, mockPinBankDdr('G'));
+  TEST_ASSERT_EQUAL_HEX16(0x100F, pinBankDirection(0));
+}
+
+static void test_walking_one() {
+  pinBankSetDirection(0, 0xFFFF);
+  for (uint8_t i=0; i<16; i++) {
+    uint16_t w = 1u<<i;
+    pinBankWrite(0, w);
+    assertPorts(w);
+    TEST_ASSERT_EQUAL_HEX16(w, pinBankLatch(0));
+    TEST_ASSERT_EQUAL_HEX16(w, pinBankRead(0));
+  }
+}
+
+static void test_patterns_round_trip() {
+  static const uint16_t words[] = { 0x0000, 0xFFFF, 0xAAAA, 0x5555, 0x1234, 0xE001, 0x0FF0, 0x8421 };
+  pinBankSetDirection(0, 0xFFFF);
+  for (uint16_t w : words) {
+    pinBankWrite(0, w);
+    assertPorts(w);
+    TEST_ASSERT_EQUAL_HEX16(w, pinBankRead(0));
+  }
+}
+
+static void test_masked_write() {
+  pinBankSetDirection(0, 0xFFFF);
+  pinBankWrite(0, 0xFFFF);
+  pinBankWrite(0, 0x0000, 0x10F0);                       // clear pins 5-8 and 13
+  assertPorts(0xEF0F);
+  TEST_ASSERT_EQUAL_HEX16(0xEF0F, pinBankLatch(0));
+}
+
+static void test_inputs_read_external() {
+  static const uint16_t words[] = { 0xFFFF, 0x8001, 0x1248, 0x7FFE };
+  for (uint16_t w : words) {
+    mockPinBankSetExternal(0, w);
+    TEST_ASSERT_EQUAL_HEX16(w, pinBankRead(0));
+    assertPorts(0);                                      // no pull-ups turned on
+  }
+}
+
+static void test_mixed_read_and_release() {
+  // Pins 1-8 driven by the tester, 9-16 by the DUT.
+  pinBankSetDirection(0, 0x00FF);
+  pinBankWrite(0, 0x00A5);
+  mockPinBankSetExternal(0, 0xC3FF);
+  TEST_ASSERT_EQUAL_HEX16(0xC3A5, pinBankRead(0));
+
+  // Released pins lose their PORT bit and read the DUT's level again.
+  pinBankSetDirection(0, 0x000F);
+  assertPorts(0x0005);
+  TEST_ASSERT_EQUAL_HEX16(0xC3F5, pinBankRead(0));
+}
+
+static void test_bank1_maps_to_f_and_k() {
+  pinBankSetDirection(1, 0xFFFF);
+  pinBankWrite(1, 0x9C35);
+  TEST_ASSERT_EQUAL_HEX8(0x35, mockPinBankPort('F'));
+  TEST_ASSERT_EQUAL_HEX8(0x9C, mockPinBankPort('K'));
+  TEST_ASSERT_EQUAL_HEX16(0x9C35, pinBankRead(1));
+  assertPorts(0);                                        // bank 0 untouched
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_direction_mask);
+  RUN_TEST(test_walking_one);
+  RUN_TEST(test_patterns_round_trip);
+  RUN_TEST(test_masked_write);
+  RUN_TEST(test_inputs_read_external);
+  RUN_TEST(test_mixed_read_and_release);
+  RUN_TEST(test_bank1_maps_to_f_and_k);
+  return UNITY_END();
+}
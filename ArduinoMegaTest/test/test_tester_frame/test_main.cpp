@@ -0,0 +1,180 @@
+// SharedLib/TesterFrame: CRC, encoder, byte-at-a-time parser and pin string
+// packing.  pio test -e native -f test_tester_frame
+#include <string.h>
+#include <unity.h>
+#include "TesterFrame.h"
+
+static FrameParser rx;
+
+// Feeds n bytes; returns how many complete frames came out (the last one is
+// left in rx.frame).
+static int feedAll(const uint8_t *p, uint8_t n) {
+  int frames = 0;
+  for (uint8_t i = 0; i < n; i++)
+    if (rx.feed(p[i])) frames++;
+  return frames;
+}
+
+static uint8_t encodeText(uint8_t op, const char *text, uint8_t *out) {
+  return frameEncode(op, (const uint8_t *)text, strlen(text), out);
+}
+
+static void assertFrame(uint8_t op, const char *text) {
+  TEST_ASSERT_EQUAL_HEX8(op, rx.frame.op);
+  TEST_ASSERT_EQUAL(strlen(text), rx.frame.len);
+  TEST_ASSERT_EQUAL_MEMORY(text, rx.frame.data, rx.frame.len);
+}
+
+void setUp() {
+  rx = FrameParser();
+}
+
+void tearDown() {}
+
+static void test_crc8_known_values() {
+  // CRC-8/SMBUS (poly 0x07, init 0, no reflection): check value of "123456789".
+  TEST_ASSERT_EQUAL_HEX8(0xF4, frameCrc8((const uint8_t *)"123456789", 9));
+  TEST_ASSERT_EQUAL_HEX8(0x00, frameCrc8(nullptr, 0));
+  const uint8_t one = 0x01;
+  TEST_ASSERT_EQUAL_HEX8(0x07, frameCrc8(&one, 1));
+  // Chaining through the crc argument equals one pass.
+  const uint8_t *s = (const uint8_t *)"123456789";
+  TEST_ASSERT_EQUAL_HEX8(0xF4, frameCrc8(s + 4, 5, frameCrc8(s, 4)));
+}
+
+static void test_encode_layout() {
+  uint8_t buf[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+  TEST_ASSERT_EQUAL(8, encodeText(OP_IC, "7400", buf));
+  TEST_ASSERT_EQUAL_HEX8(FRAME_SOF, buf[0]);
+  TEST_ASSERT_EQUAL_HEX8(OP_IC, buf[1]);
+  TEST_ASSERT_EQUAL(4, buf[2]);
+  TEST_ASSERT_EQUAL_MEMORY("7400", buf + 3, 4);
+  TEST_ASSERT_EQUAL_HEX8(frameCrc8(buf + 1, 6), buf[7]);
+
+  TEST_ASSERT_EQUAL(FRAME_OVERHEAD, frameEncode(OP_SYNC, nullptr, 0, buf));
+  TEST_ASSERT_EQUAL(0, buf[2]);
+}
+
+static void test_round_trip() {
+  uint8_t buf[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+  TEST_ASSERT_EQUAL(1, feedAll(buf, encodeText(OP_CMD, "CLOCK:SET:1000", buf)));
+  assertFrame(OP_CMD, "CLOCK:SET:1000");
+
+  TEST_ASSERT_EQUAL(1, feedAll(buf, frameEncode(OP_SYNC, nullptr, 0, buf)));
+  TEST_ASSERT_EQUAL_HEX8(OP_SYNC, rx.frame.op);
+  TEST_ASSERT_EQUAL(0, rx.frame.len);
+
+  uint8_t payload[FRAME_MAX_PAYLOAD];
+  for (uint8_t i = 0; i < FRAME_MAX_PAYLOAD; i++) payload[i] = 0xFF - i;  // includes 0xA5
+  TEST_ASSERT_EQUAL(1, feedAll(buf, frameEncode(OP_CAPTURE, payload, FRAME_MAX_PAYLOAD, buf)));
+  TEST_ASSERT_EQUAL(FRAME_MAX_PAYLOAD, rx.frame.len);
+  TEST_ASSERT_EQUAL_MEMORY(payload, rx.frame.data, FRAME_MAX_PAYLOAD);
+  TEST_ASSERT_EQUAL(0, rx.crcErrors);
+}
+
+static void test_resync_after_garbage() {
+  uint8_t buf[64];
+  const char junk[] = "ERR:INVALID_CMD\r\nIC Logic Tester\r\n";
+  uint8_t n = strlen(junk);
+  memcpy(buf, junk, n);
+  n += encodeText(OP_IC, "74157", buf + n);
+  TEST_ASSERT_EQUAL(1, feedAll(buf, n));
+  assertFrame(OP_IC, "74157");
+  TEST_ASSERT_EQUAL(0, rx.crcErrors);
+}
+
+static void test_length_overflow_rejected() {
+  const uint8_t bad[] = { FRAME_SOF, OP_CMD, FRAME_MAX_PAYLOAD + 1 };
+  TEST_ASSERT_EQUAL(0, feedAll(bad, sizeof bad));
+  // Back to hunting at once: the next frame is not swallowed as payload.
+  uint8_t buf[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+  TEST_ASSERT_EQUAL(1, feedAll(buf, encodeText(OP_IC, "7432", buf)));
+  assertFrame(OP_IC, "7432");
+
+  // The encoder never produces such a frame.
+  uint8_t payload[FRAME_MAX_PAYLOAD + 8] = { 0 };
+  TEST_ASSERT_EQUAL(FRAME_MAX_PAYLOAD + FRAME_OVERHEAD, frameEncode(OP_CMD, payload, sizeof payload, buf));
+  TEST_ASSERT_EQUAL(FRAME_MAX_PAYLOAD, buf[2]);
+}
+
+static void test_corrupted_crc() {
+  uint8_t buf[2 * (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)];
+  uint8_t n = encodeText(OP_CMD, "INFO", buf);
+  buf[n - 1] ^= 0x01;
+  TEST_ASSERT_EQUAL(0, feedAll(buf, n));
+  TEST_ASSERT_EQUAL(1, rx.crcErrors);
+
+  // A flipped payload bit is caught the same way.
+  n = encodeText(OP_CMD, "INFO", buf);
+  buf[4] ^= 0x20;
+  TEST_ASSERT_EQUAL(0, feedAll(buf, n));
+  TEST_ASSERT_EQUAL(2, rx.crcErrors);
+
+  n = encodeText(OP_CMD, "INFO", buf);
+  TEST_ASSERT_EQUAL(1, feedAll(buf, n));
+  assertFrame(OP_CMD, "INFO");
+}
+
+static void test_truncated_frame() {
+  uint8_t buf[3 * (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)];
+  // An OP_IC frame announcing 5 bytes of payload, cut after 2 of them.
+  encodeText(OP_IC, "74164", buf);
+  uint8_t first = 5;
+  uint8_t second = first + encodeText(OP_IC, "7400", buf + first);
+  uint8_t n = second + encodeText(OP_IC, "7404", buf + second);
+
+  // The cut frame takes the head of the next one as its payload and fails
+  // its CRC; nothing is delivered for either.
+  TEST_ASSERT_EQUAL(0, feedAll(buf, second));
+  TEST_ASSERT_EQUAL(1, rx.crcErrors);
+  // The parser is hunting again and the following frame comes through.
+  TEST_ASSERT_EQUAL(1, feedAll(buf + second, n - second));
+  assertFrame(OP_IC, "7404");
+
+  // A receiver that drops a half-received frame (reset(), as on BIN:ON)
+  // loses nothing after it.
+  rx = FrameParser();
+  feedAll(buf, first);
+  rx.reset();
+  TEST_ASSERT_EQUAL(2, feedAll(buf + first, n - first));
+  assertFrame(OP_IC, "7404");
+}
+
+static void test_pin_string_round_trip() {
+  const char *strings[] = { "0", "1", "01", "10110011100011", "1111111111111111", "0000000000000001" };
+  for (const char *s : strings) {
+    uint8_t payload[3];
+    char back[17];
+    TEST_ASSERT_EQUAL(3, packPinString(s, strlen(s), payload));
+    TEST_ASSERT_EQUAL(strlen(s), payload[0]);
+    TEST_ASSERT_EQUAL(strlen(s), unpackPinString(payload, back));
+    TEST_ASSERT_EQUAL_STRING(s, back);
+  }
+
+  // Bit j is character j.
+  uint8_t payload[3];
+  packPinString("1000000010000001", 16, payload);
+  TEST_ASSERT_EQUAL_HEX8(0x01, payload[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x81, payload[2]);
+
+  // Strings past 16 pins are cut to 16, and so are bad counts on the way back.
+  char back[17];
+  packPinString("11111111111111110", 17, payload);
+  TEST_ASSERT_EQUAL(16, payload[0]);
+  payload[0] = 40;
+  TEST_ASSERT_EQUAL(16, unpackPinString(payload, back));
+  TEST_ASSERT_EQUAL(16, strlen(back));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc8_known_values);
+  RUN_TEST(test_encode_layout);
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_resync_after_garbage);
+  RUN_TEST(test_length_overflow_rejected);
+  RUN_TEST(test_corrupted_crc);
+  RUN_TEST(test_truncated_frame);
+  RUN_TEST(test_pin_string_round_trip);
+  return UNITY_END();
+}
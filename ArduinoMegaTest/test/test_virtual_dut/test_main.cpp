@@ -0,0 +1,151 @@
+// Single-fault campaign against the virtual DUTs, per part of the table: the
+// exhaustive sweep must catch every fault vdutFaultList() produces, and the
+// structural test set of a gate part every stuck-at and open fault. The one
+// allowed escape is a bridge between two inputs of the same AND/NAND gate
+// (see VirtualDUT.h).  pio test -e native -f test_virtual_dut
+#include <stdio.h>
+#include <unity.h>
+#include "ClockGen.h"
+#include "PinBank.h"
+#include "Socket.h"
+#include "Sweep.h"
+#include "VirtualDUT.h"
+
+static const uint16_t MAX_FAULTS = 64;
+
+// Both pins feed only the one gate, an AND or NAND: the short ANDs them
+// before the gate does, so no input word tells it apart.
+static bool sameGateInputBridge(const ICProfile &ic, const Fault &f) {
+  if (f.kind != FAULT_BRIDGE) return false;
+  int8_t gate = -1;
+  for (uint8_t g = 0; g < ic.gateCount; g++) {
+    const LogicGate &lg = ic.gates[g];
+    bool a = false, b = false;
+    for (uint8_t k = 0; k < lg.inputCount; k++) {
+      a |= lg.inputs[k] == f.pin + 1;            // gate pins count from 1
+      b |= lg.inputs[k] == f.other + 1;
+    }
+    if (!a && !b) continue;
+    if (!a || !b || gate >= 0) return false;
+    gate = g;
+  }
+  return gate >= 0 && (ic.gates[gate].type == AND || ic.gates[gate].type == NAND);
+}
+
+static void describe(const ICProfile &ic, const Fault &f, const char *path, char *msg, size_t n) {
+  if (f.kind == FAULT_BRIDGE)
+    snprintf(msg, n, "%s: %s escaped %s %d:%d", ic.name, path, faultName(f.kind), f.pin + 1, f.other + 1);
+  else
+    snprintf(msg, n, "%s: %s escaped %s %d", ic.name, path, faultName(f.kind), f.pin + 1);
+}
+
+// Puts part index in socket 0 with a virtual copy of it; false if the part
+// has nothing to sweep (no gates, no model).
+static bool insertPart(uint8_t index) {
+  Socket &s = sockets[0];
+  loadProfile(index, s.ic);
+  if (!s.ic.gateCount && s.ic.model == MODEL_NONE) return false;
+  s.loaded = true;
+  socketConfigure(s);
+  vdutInsert(s.bank, s.ic);
+  return true;
+}
+
+void setUp() {
+  pinBankBegin();
+  socketsBegin();
+  clockBegin();
+}
+
+void tearDown() {
+  vdutSetFault(sockets[0].bank, {FAULT_NONE, 0, 0});
+  vdutRemove(sockets[0].bank);
+}
+
+static void test_good_parts_pass() {
+  for (uint8_t i = 0; i < IC_DB_COUNT; i++) {
+    if (!insertPart(i)) continue;
+    const ICProfile &ic = sockets[0].ic;
+    SweepResult r;
+    TEST_ASSERT_TRUE_MESSAGE(runSweep(ic, sockets[0].bank, ic.inputMask, r), ic.name);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, r.failures, ic.name);
+    vdutRemove(sockets[0].bank);
+  }
+}
+
+static void test_sweep_catches_every_fault() {
+  uint8_t parts = 0;
+  for (uint8_t i = 0; i < IC_DB_COUNT; i++) {
+    if (!insertPart(i)) continue;
+    const ICProfile &ic = sockets[0].ic;
+    uint8_t bank = sockets[0].bank;
+    Fault faults[MAX_FAULTS];
+    uint16_t n = vdutFaultList(ic, faults, MAX_FAULTS);
+    TEST_ASSERT_TRUE_MESSAGE(n > 0 && n <= MAX_FAULTS, ic.name);
+    for (uint16_t k = 0; k < n; k++) {
+      SweepResult r;
+      vdutSetFault(bank, faults[k]);
+      TEST_ASSERT_TRUE(runSweep(ic, bank, ic.inputMask, r));
+      if (r.failures) continue;
+      char msg[64];
+      describe(ic, faults[k], "sweep", msg, sizeof msg);
+      TEST_ASSERT_TRUE_MESSAGE(sameGateInputBridge(ic, faults[k]), msg);
+    }
+    vdutSetFault(bank, {FAULT_NONE, 0, 0});
+    vdutRemove(bank);
+    parts++;
+  }
+  TEST_ASSERT_TRUE(parts > 0);
+}
+
+static void test_test_sets_catch_stuck_and_open() {
+  for (uint8_t i = 0; i < IC_DB_COUNT; i++) {
+    ICTestSet ts;
+    loadTestSet(i, ts);
+    if (!ts.count || !insertPart(i)) continue;
+    const ICProfile &ic = sockets[0].ic;
+    uint8_t bank = sockets[0].bank;
+    Fault faults[MAX_FAULTS];
+    uint16_t n = vdutFaultList(ic, faults, MAX_FAULTS);
+    for (uint16_t k = 0; k < n; k++) {
+      if (faults[k].kind == FAULT_BRIDGE) continue;
+      SweepResult r;
+      vdutSetFault(bank, faults[k]);
+      TEST_ASSERT_TRUE(runTestSet(ic, bank, ic.inputMask, r));
+      char msg[64];
+      describe(ic, faults[k], "test set", msg, sizeof msg);
+      TEST_ASSERT_TRUE_MESSAGE(r.failures > 0, msg);
+    }
+    vdutSetFault(bank, {FAULT_NONE, 0, 0});
+    vdutRemove(bank);
+  }
+}
+
+// The 7473 keeps GND on chip pin 11, yet as a 14-pin DIP its far row still
+// sits on socket pins 10-16: cleared flip-flops show Q low / Q-bar high there.
+static void test_7473_outputs_on_socket_10_to_16() {
+  int8_t idx = findProfile("7473");
+  TEST_ASSERT_TRUE(idx >= 0);
+  TEST_ASSERT_TRUE(insertPart(idx));
+  const ICProfile &ic = sockets[0].ic;
+  uint8_t bank = sockets[0].bank;
+  TEST_ASSERT_EQUAL_HEX16(0x6600, ic.outputMask);        // 2Q-bar, 2Q, 1Q, 1Q-bar on 10, 11, 14, 15
+  TEST_ASSERT_EQUAL_HEX16(0x1000, ic.gndMask);           // chip pin 11
+  TEST_ASSERT_EQUAL_HEX16(0x0180, ic.ncMask);            // socket pins 8/9
+
+  pinBankWrite(bank, 0, ic.inputMask | ic.clockMask);    // both CLR low
+  uint16_t w = pinBankRead(bank);
+  TEST_ASSERT_FALSE(w & 1u<<13);                         // 1Q
+  TEST_ASSERT_TRUE(w & 1u<<14);                          // 1Q-bar
+  TEST_ASSERT_FALSE(w & 1u<<10);                         // 2Q
+  TEST_ASSERT_TRUE(w & 1u<<9);                           // 2Q-bar
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_good_parts_pass);
+  RUN_TEST(test_sweep_catches_every_fault);
+  RUN_TEST(test_test_sets_catch_stuck_and_open);
+  RUN_TEST(test_7473_outputs_on_socket_10_to_16);
+  return UNITY_END();
+}
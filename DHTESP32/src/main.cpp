@@ -28,6 +28,7 @@ BLECharacteristic *pStatusChar = NULL;
 bool deviceConnected = false;
 bool oldDeviceConnected = false;
 bool bleEnabled = false;
+unsigned long lastStatusUpdate = 0;
 String currentIC = "";
 
 class MyServerCallbacks : public BLEServerCallbacks
@@ -218,11 +219,12 @@ void loop()
   }
 
   // Send status updates to BLE
-  if (bleEnabled && deviceConnected && (millis() % 5000 == 0))
+  if (bleEnabled && deviceConnected && millis() - lastStatusUpdate >= 5000)
   {
     const char *status = "STATUS:OK";
     pStatusChar->setValue(status);
     pStatusChar->notify();
+    lastStatusUpdate = millis();
   }
 
   delay(10);
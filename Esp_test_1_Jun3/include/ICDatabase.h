@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+
+struct ICPinConfig
+{
+  uint8_t number;
+  const char *type; // VCC, GND, INPUT, OUTPUT, NC
+  bool isActiveLow;
+};
+
+struct ICProfile
+{
+  const char *name;
+  ICPinConfig pins[14];
+};
+
+// The 14-pin parts of the front end's JSON part library, generated into
+// src/ICTable.gen.cpp at build time by SharedLib/ICLibrary/icgen.py.
+extern const ICProfile IC_DB[];
+extern const uint8_t IC_DB_COUNT;
+
+// Any name of the part (part number or generic 74xx number), nullptr if unknown
+const ICProfile *findIC(const char *name);
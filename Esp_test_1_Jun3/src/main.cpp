@@ -1,47 +1,16 @@
 #include <Arduino.h>
+#include <PinReporter.h>
+#include "ICDatabase.h"
 
 // ESP32 Safe GPIO Configuration
 const uint8_t IC_PINS[14] = {4, 5, 13, 14, 16, 17, 18, 19, 21, 22, 23, 25, 26, 27}; // Safe pins for IC connection
 const uint8_t BUTTON_PINS[8] = {32, 33, 34, 35, 36, 39, 36, 39};                    // Input-only pins for buttons
 
-struct ICPinConfig
-{
-  uint8_t number;
-  const char *type; // VCC, GND, INPUT, OUTPUT
-  bool isActiveLow;
-};
-
-struct ICProfile
-{
-  const char *name;
-  ICPinConfig pins[14];
-};
-
-// IC Database with common logic ICs
-ICProfile IC_DB[] = {
-    {// 7432 Quad 2-Input OR
-     "7432",
-     {{1, "INPUT", false}, {2, "INPUT", false}, {3, "OUTPUT", false}, {4, "INPUT", false}, {5, "INPUT", false}, {6, "OUTPUT", false}, {7, "GND", false}, {8, "OUTPUT", false}, {9, "INPUT", false}, {10, "INPUT", false}, {11, "OUTPUT", false}, {12, "INPUT", false}, {13, "INPUT", false}, {14, "VCC", false}}},
-    {// 7404 Hex Inverter
-     "7404",
-     {{1, "INPUT", false}, {2, "OUTPUT", false}, {3, "INPUT", false}, {4, "OUTPUT", false}, {5, "INPUT", false}, {6, "OUTPUT", false}, {7, "GND", false}, {8, "OUTPUT", false}, {9, "INPUT", false}, {10, "OUTPUT", false}, {11, "INPUT", false}, {12, "OUTPUT", false}, {13, "INPUT", false}, {14, "VCC", false}}},
-    {// 7400 Quad NAND
-     "7400",
-     {{1, "INPUT", false}, {2, "INPUT", false}, {3, "OUTPUT", false}, {4, "INPUT", false}, {5, "INPUT", false}, {6, "OUTPUT", false}, {7, "GND", false}, {8, "OUTPUT", false}, {9, "INPUT", false}, {10, "INPUT", false}, {11, "OUTPUT", false}, {12, "INPUT", false}, {13, "INPUT", false}, {14, "VCC", false}}},
-    {// 7408 Quad AND
-     "7408",
-     {{1, "INPUT", false}, {2, "INPUT", false}, {3, "OUTPUT", false}, {4, "INPUT", false}, {5, "INPUT", false}, {6, "OUTPUT", false}, {7, "GND", false}, {8, "OUTPUT", false}, {9, "INPUT", false}, {10, "INPUT", false}, {11, "OUTPUT", false}, {12, "INPUT", false}, {13, "INPUT", false}, {14, "VCC", false}}},
-    {// 7486 Quad XOR
-     "7486",
-     {{1, "INPUT", false}, {2, "INPUT", false}, {3, "OUTPUT", false}, {4, "INPUT", false}, {5, "INPUT", false}, {6, "OUTPUT", false}, {7, "GND", false}, {8, "OUTPUT", false}, {9, "INPUT", false}, {10, "INPUT", false}, {11, "OUTPUT", false}, {12, "INPUT", false}, {13, "INPUT", false}, {14, "VCC", false}}},
-    {// 7402 Quad NOR
-     "7402",
-     {{1, "OUTPUT", false}, {2, "INPUT", false}, {3, "INPUT", false}, {4, "OUTPUT", false}, {5, "INPUT", false}, {6, "INPUT", false}, {7, "GND", false}, {8, "INPUT", false}, {9, "INPUT", false}, {10, "OUTPUT", false}, {11, "INPUT", false}, {12, "INPUT", false}, {13, "OUTPUT", false}, {14, "VCC", false}}}};
-
-ICProfile *currentIC = nullptr;
+const ICProfile *currentIC = nullptr;
 bool lastButtonStates[8] = {false};
 uint8_t inputPinMapping[8]; // Maps button index to IC pin index
 uint8_t inputPinCount = 0;
+PinReporter reporter; // Change-driven PINS/PD stream
 
 void setupInputMapping()
 {
@@ -108,6 +77,37 @@ String getPinStates()
   return result;
 }
 
+// Same order as getPinStates(): bit j is character j of the pin string
+uint16_t getPinWord()
+{
+  uint16_t word = 0;
+  for (int j = 0; j < 14; j++)
+    if (digitalRead(IC_PINS[13 - j]))
+      word |= 1u << j;
+  return word;
+}
+
+// Changed pins go out as "PD:<ms>:<changed>:<value>" (hex over the pin
+// string bits); a full PINS line is sent as heartbeat and after IC selection.
+void reportPins()
+{
+  ReportKind kind = reporter.poll(getPinWord(), millis());
+  if (kind == REPORT_FULL)
+  {
+    Serial.print("PINS:");
+    Serial.println(getPinStates());
+  }
+  else if (kind == REPORT_DELTA)
+  {
+    Serial.print("PD:");
+    Serial.print(reporter.stamp());
+    Serial.print(':');
+    Serial.print(reporter.changed(), HEX);
+    Serial.print(':');
+    Serial.println(reporter.value(), HEX);
+  }
+}
+
 void setInputPins(String pinData)
 {
   if (!currentIC || pinData.length() != 14)
@@ -132,22 +132,15 @@ void handleSerial()
 
     if (cmd.startsWith("IC:"))
     {
-      String icName = cmd.substring(3);
-      bool found = false;
-
-      for (int i = 0; i < sizeof(IC_DB) / sizeof(IC_DB[0]); i++)
+      const ICProfile *ic = findIC(cmd.substring(3).c_str());
+      if (ic)
       {
-        if (icName.equals(IC_DB[i].name))
-        {
-          currentIC = &IC_DB[i];
-          configurePins();
-          Serial.println("OK:IC_SELECTED");
-          found = true;
-          break;
-        }
+        currentIC = ic;
+        configurePins();
+        reporter.force();
+        Serial.println("OK:IC_SELECTED");
       }
-
-      if (!found)
+      else
         Serial.println("ERR:IC_NOT_FOUND");
     }
     else if (cmd.startsWith("PINS:"))
@@ -194,10 +187,23 @@ void handleSerial()
       else
         Serial.println("STATUS:NO_IC");
     }
+    else if (cmd.startsWith("REPORT:"))
+    {
+      // REPORT:<min interval ms>,<heartbeat ms>
+      int comma = cmd.indexOf(',');
+      if (comma < 0)
+      {
+        Serial.println("ERR:INVALID_REPORT");
+        return;
+      }
+      reporter.minIntervalMs = cmd.substring(7, comma).toInt();
+      reporter.heartbeatMs = cmd.substring(comma + 1).toInt();
+      Serial.println("OK:REPORT");
+    }
     else if (cmd == "LIST")
     {
       Serial.println("AVAILABLE_ICS:");
-      for (int i = 0; i < sizeof(IC_DB) / sizeof(IC_DB[0]); i++)
+      for (int i = 0; i < IC_DB_COUNT; i++)
       {
         Serial.println(IC_DB[i].name);
       }
@@ -246,7 +252,7 @@ void setup()
 {
   Serial.begin(115200);
   Serial.println("ESP32 IC Tester Ready");
-  Serial.println("Commands: IC:<name>, PINS:<14bits>, STATUS, LIST");
+  Serial.println("Commands: IC:<name>, PINS:<14bits>, STATUS, LIST, REPORT:<ms>,<ms>");
 
   // Initialize button pins
   for (int i = 0; i < 8; i++)
@@ -262,17 +268,9 @@ void loop()
   handleSerial();
   // handleButtons();
 
-  // Send pin states periodically
+  // Report pin changes as they happen
   if (currentIC)
-  {
-    static unsigned long lastUpdate = 0;
-    if (millis() - lastUpdate > 10000) // 10Hz update rate
-    {
-      Serial.print("PINS:");
-      Serial.println(getPinStates());
-      lastUpdate = millis();
-    }
-  }
+    reportPins();
 
   delay(1); // Small delay to prevent watchdog issues
 }
\ No newline at end of file
@@ -19,6 +19,18 @@ const IC_CHAR_UUID = "00000001-0000-1000-8000-00805f9b34fb";
 const PINS_CHAR_UUID = "00000002-0000-1000-8000-00805f9b34fb";
 const CLOCK_CHAR_UUID = "00000003-0000-1000-8000-00805f9b34fb";
 const STATUS_CHAR_UUID = "00000004-0000-1000-8000-00805f9b34fb";
+const STREAM_CHAR_UUID = "00000005-0000-1000-8000-00805f9b34fb";
+
+// Pin sample stream (see BLEReadme.md): a 6-byte header (seq, count, t0 ms)
+// followed by count 4-byte samples (dt ms, pin word), all little-endian.
+const STREAM_HEADER = 6;
+const STREAM_SAMPLE = 4;
+const STREAM_HISTORY = 4096; // samples kept for inspection
+
+interface PinSample {
+  ms: number;   // tester bridge time
+  pins: number; // bit j = pin j + 1
+}
 
 export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterfaceProps = {}) {
   const [device, setDevice] = useState<BLEDevice | null>(null);
@@ -41,7 +53,13 @@ export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterf
     pins?: BluetoothRemoteGATTCharacteristic;
     clock?: BluetoothRemoteGATTCharacteristic;
     status?: BluetoothRemoteGATTCharacteristic;
+    stream?: BluetoothRemoteGATTCharacteristic;
   }>({});
+  const streamRef = useRef<{ seq: number | null; samples: PinSample[]; lost: number }>({
+    seq: null,
+    samples: [],
+    lost: 0,
+  });
 
   const isBLESupported = typeof navigator !== 'undefined' && 'bluetooth' in navigator;
 
@@ -117,6 +135,18 @@ export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterf
       characteristicsRef.current = { ic: icChar, pins: pinsChar, clock: clockChar, status: statusChar };
       addLogEntry("info", "Characteristics obtained.");
 
+      // Older firmware has no stream characteristic; fall back to the pins notifications
+      try {
+        const streamChar = await bleService.getCharacteristic(STREAM_CHAR_UUID);
+        characteristicsRef.current.stream = streamChar;
+        streamRef.current = { seq: null, samples: [], lost: 0 };
+        await streamChar.startNotifications();
+        streamChar.addEventListener('characteristicvaluechanged', handleIncomingPinStream);
+        addLogEntry("info", "Notifications started for Pin Stream.");
+      } catch {
+        addLogEntry("info", "Pin Stream characteristic not available.");
+      }
+
       if (pinsChar.properties.notify) {
         await pinsChar.startNotifications();
         pinsChar.addEventListener('characteristicvaluechanged', handleIncomingPinStateChange);
@@ -158,6 +188,10 @@ export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterf
         await characteristicsRef.current.status.stopNotifications();
         characteristicsRef.current.status.removeEventListener('characteristicvaluechanged', handleIncomingStatusChange);
       }
+      if (characteristicsRef.current.stream) {
+        await characteristicsRef.current.stream.stopNotifications();
+        characteristicsRef.current.stream.removeEventListener('characteristicvaluechanged', handleIncomingPinStream);
+      }
       await device.gatt.disconnect();
       // gattserverdisconnected event will call handleDisconnectionEvent
       addLogEntry("info", "Disconnected successfully.");
@@ -191,6 +225,45 @@ export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterf
     }
   };
 
+  // Handle batched pin samples from device (notifications). Every sample is
+  // kept in streamRef; the UI only needs the newest one.
+  const handleIncomingPinStream = (event: Event) => {
+    const characteristic = event.target as BluetoothRemoteGATTCharacteristic;
+    const value = characteristic.value;
+    if (!value || value.byteLength < STREAM_HEADER) return;
+
+    const seq = value.getUint8(0);
+    const count = value.getUint8(1);
+    const t0 = value.getUint32(2, true);
+    if (value.byteLength < STREAM_HEADER + count * STREAM_SAMPLE) {
+      addLogEntry("warning", `Truncated pin stream packet: ${value.byteLength} bytes for ${count} samples`);
+      return;
+    }
+    const stream = streamRef.current;
+    if (stream.seq !== null && seq !== ((stream.seq + 1) & 0xff)) {
+      const missed = (seq - stream.seq - 1) & 0xff;
+      stream.lost += missed;
+      addLogEntry("warning", `Pin stream lost ${missed} packet(s) (${stream.lost} total)`);
+    }
+    stream.seq = seq;
+    if (count === 0) return;
+
+    for (let i = 0; i < count; i++) {
+      const offset = STREAM_HEADER + i * STREAM_SAMPLE;
+      stream.samples.push({ ms: t0 + value.getUint16(offset, true), pins: value.getUint16(offset + 2, true) });
+    }
+    if (stream.samples.length > STREAM_HISTORY) {
+      stream.samples.splice(0, stream.samples.length - STREAM_HISTORY);
+    }
+
+    const pins = stream.samples[stream.samples.length - 1].pins;
+    const newPinStates: { [key: number]: boolean } = {};
+    for (let i = 0; i < 16; i++) {
+      newPinStates[i + 1] = (pins & (1 << i)) !== 0;
+    }
+    setPinStates(newPinStates);
+  };
+
   // Handle status messages from device (notifications)
   const handleIncomingStatusChange = (event: Event) => {
     const characteristic = event.target as BluetoothRemoteGATTCharacteristic;
@@ -356,6 +429,9 @@ export default function BLEInterface({ onICSelect: parentOnICSelect }: BLEInterf
             if (characteristicsRef.current.status?.properties.notify) {
               try { await characteristicsRef.current.status.stopNotifications(); } catch (e) { /* ignore */ }
             }
+            if (characteristicsRef.current.stream) {
+              try { await characteristicsRef.current.stream.stopNotifications(); } catch (e) { /* ignore */ }
+            }
           };
           stopNotifications().finally(() => {
             dev.gatt?.disconnect();
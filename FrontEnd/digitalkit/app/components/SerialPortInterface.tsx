@@ -647,6 +647,32 @@ export default function SerialPortInterface({
         return;
       }
 
+      // Pin deltas: PD:<ms>:<changed hex>:<value hex>, bit j = pin j + 1
+      if (command.startsWith("PD:")) {
+        const [, , changedHex, valueHex] = command.split(":");
+        const changed = parseInt(changedHex, 16);
+        const value = parseInt(valueHex, 16);
+        if (isNaN(changed) || isNaN(value)) {
+          setDebugLogs((prev) => [
+            ...prev,
+            {
+              timestamp: new Date().toISOString(),
+              type: "error",
+              message: `Invalid pin delta: ${command}`,
+            },
+          ]);
+          return;
+        }
+        setPinStates((prev) => {
+          const next = { ...prev };
+          for (let j = 0; j < 16; j++) {
+            if (changed & (1 << j)) next[j + 1] = (value & (1 << j)) !== 0;
+          }
+          return next;
+        });
+        return;
+      }
+
       // Parse the pin states from the PINS: command format (backward compatibility)
       if (command.startsWith("PINS:")) {
         console.log("Processing PINS command:", command);
@@ -3,6 +3,12 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 #include <HardwareSerial.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <DisplayCache.h>
+#include <SpscRing.h>
+#include <Telemetry.h>
+#include <TesterFrame.h>
 
 // BLE UUIDs
 #define SERVICE_UUID "00000000-0000-1000-8000-00805f9b34fb"
@@ -10,11 +16,60 @@
 #define PINS_CHAR_UUID "00000002-0000-1000-8000-00805f9b34fb"
 #define CLOCK_CHAR_UUID "00000003-0000-1000-8000-00805f9b34fb"
 #define STATUS_CHAR_UUID "00000004-0000-1000-8000-00805f9b34fb"
+#define STREAM_CHAR_UUID "00000005-0000-1000-8000-00805f9b34fb"
 
 // Nextion UART Configuration
 #define NEXTION_RX 16 // GPIO16 for RX (ESP32 <- Nextion TX)
 #define NEXTION_TX 17 // GPIO17 for TX (ESP32 -> Nextion RX)
+#define NEXTION_BAUD_DEFAULT 9600 // what a freshly powered display listens at
+#ifndef NEXTION_TARGET_BAUD
+#define NEXTION_TARGET_BAUD 115200
+#endif
+#define NEXTION_PROBE_MS 100  // wait for the "sendme" reply
+#define NEXTION_SWITCH_MS 20  // let the display apply baud= before probing
+#define NEXTION_BATCH_MAX 256 // state writes collected per nextionTask pass
+#define NEXTION_REFRESH_MS 10000 // resend state this often in case the display was reset
 HardwareSerial SerialNextion(1);
+unsigned long nextionBaud = NEXTION_BAUD_DEFAULT;
+
+// Task layout
+//   nextionTask (core 1)  Nextion UART in and out
+//   usbTask     (core 1)  USB serial in and out, ASCII lines or TesterFrame frames
+//   bleTask     (core 0)  BLE server next to the BT stack: start/stop,
+//                         re-advertising, notifications, status
+// Each task owns its transport. Messages between them are text lines on one
+// SPSC ring per direction, and the receiver is woken by a task notification.
+// BLE stack callbacks only push into bleInbox, so they never wait on a UART.
+#define MSG_MAX 64
+#define RING_SIZE 16
+#define LINE_IDLE_MS 20 // a line without '\n' ends after this much silence
+#define READVERTISE_MS 500
+#define STATUS_INTERVAL_MS 5000
+
+struct BridgeMsg
+{
+  uint32_t ms; // millis() when posted
+  uint8_t len;
+  char text[MSG_MAX];
+};
+typedef SpscRing<BridgeMsg, RING_SIZE> MsgRing;
+
+static MsgRing nextionToUsb, nextionToBle;
+static MsgRing usbToNextion, usbToBle;
+static MsgRing bleToNextion, bleToUsb;
+static MsgRing bleInbox; // BLE stack callbacks -> bleTask
+static TaskHandle_t nextionTaskHandle = NULL;
+static TaskHandle_t usbTaskHandle = NULL;
+static TaskHandle_t bleTaskHandle = NULL;
+uint32_t droppedMsgs = 0;   // ring full
+uint32_t truncatedMsgs = 0; // longer than MSG_MAX - 1
+
+// Telemetry for STATS and the status characteristic. Each task only writes
+// its own histogram and link; readers may see a count mid-update.
+LoopHistogram usbLoop, nextionLoop, bleLoop; // work time per task wake-up
+LinkCounters usbLink, nextionLink, bleLink;
+void handleStats(const String &cmd);
+String statusLine();
 
 // BLE Objects
 BLEServer *pServer = NULL;
@@ -23,25 +78,421 @@ BLECharacteristic *pICChar = NULL;
 BLECharacteristic *pPinsChar = NULL;
 BLECharacteristic *pClockChar = NULL;
 BLECharacteristic *pStatusChar = NULL;
+BLECharacteristic *pStreamChar = NULL;
 
-// Connection Management
-bool deviceConnected = false;
-bool oldDeviceConnected = false;
+// Connection Management (bleTask)
+volatile bool deviceConnected = false;
 bool bleEnabled = false;
-String currentIC = "";
+unsigned long readvertiseAt = 0;
+
+// USB link framing (see TesterFrame.h); entered with "BIN:ON" (usbTask)
+bool usbBinary = false;
+FrameParser usbFrameRx;
+
+// Queues text for another task and wakes it. Never blocks: a full ring
+// drops the message.
+void post(MsgRing &ring, TaskHandle_t to, const String &text)
+{
+  BridgeMsg m;
+  m.ms = millis();
+  m.len = text.length();
+  if (text.length() >= MSG_MAX)
+  {
+    m.len = MSG_MAX - 1;
+    __atomic_fetch_add(&truncatedMsgs, 1, __ATOMIC_RELAXED);
+  }
+  memcpy(m.text, text.c_str(), m.len);
+  m.text[m.len] = 0;
+  if (!ring.push(m))
+  {
+    __atomic_fetch_add(&droppedMsgs, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (to)
+    xTaskNotifyGive(to);
+}
+
+// Collects bytes into lines ending in '\n', a Nextion 0xFF terminator or
+// LINE_IDLE_MS of silence; returns true when line holds a complete one.
+bool assembleLine(HardwareSerial &port, String &buf, unsigned long &lastRx, String &line)
+{
+  while (port.available())
+  {
+    char c = port.read();
+    lastRx = millis();
+    if (c == '\n' || (uint8_t)c == 0xFF)
+    {
+      if (!buf.length())
+        continue;
+      line = buf;
+      buf = "";
+      line.trim();
+      return true;
+    }
+    if (buf.length() < MSG_MAX - 1)
+      buf += c;
+  }
+  if (buf.length() && millis() - lastRx >= LINE_IDLE_MS)
+  {
+    line = buf;
+    buf = "";
+    line.trim();
+    return true;
+  }
+  return false;
+}
+
+// --- USB (usbTask) ---
+
+void usbSendFrame(uint8_t op, const uint8_t *payload, uint8_t len)
+{
+  uint8_t buf[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+  uint8_t n = frameEncode(op, payload, len, buf);
+  Serial.write(buf, n);
+  usbLink.tx(n);
+}
+
+// Sends a protocol line to the USB host, framed when in binary mode
+void usbSendLine(const String &line)
+{
+  if (!usbBinary)
+  {
+    Serial.println(line);
+    usbLink.tx(line.length() + 2);
+  }
+  else if (line.startsWith("PINS:"))
+  {
+    uint8_t p[3];
+    usbSendFrame(OP_PINS, p, packPinString(line.c_str() + 5, line.length() - 5, p));
+  }
+  else if (line.startsWith("IC:"))
+  {
+    usbSendFrame(OP_IC, (const uint8_t *)line.c_str() + 3, line.length() - 3);
+  }
+  else
+  {
+    usbSendFrame(OP_CMD, (const uint8_t *)line.c_str(), line.length());
+  }
+}
+
+void handleUsbMessage(const String &msg)
+{
+  if (msg.startsWith("IC:"))
+  {
+    String ic = msg.substring(3);
+    usbSendLine("IC:" + ic);
+
+    // Update Nextion and BLE
+    post(usbToNextion, nextionTaskHandle, "t0.txt=\"" + ic + "\"");
+    post(usbToBle, bleTaskHandle, msg);
+  }
+  else if (msg.startsWith("PINS:"))
+  {
+    // Forward to Nextion and BLE
+    post(usbToNextion, nextionTaskHandle, msg);
+    post(usbToBle, bleTaskHandle, msg);
+  }
+  else if (msg.startsWith("PD:"))
+  {
+    // Tester pin deltas only feed the BLE sample stream
+    post(usbToBle, bleTaskHandle, msg);
+  }
+  else if (msg == "STATS" || msg == "STATS:CLEAR")
+  {
+    handleStats(msg);
+  }
+  else if (msg == "BIN:ON")
+  {
+    usbSendLine("OK:BIN");
+    usbBinary = true;
+    usbFrameRx.reset();
+  }
+}
+
+void handleUsbFrame(const Frame &f)
+{
+  char text[FRAME_MAX_PAYLOAD + 1];
+  switch (f.op)
+  {
+  case OP_SYNC:
+    break;
+  case OP_IC:
+  case OP_CMD:
+    memcpy(text, f.data, f.len);
+    text[f.len] = 0;
+    handleUsbMessage(f.op == OP_IC ? String("IC:") + text : String(text));
+    break;
+  case OP_PINS:
+    if (f.len != 3)
+    {
+      uint8_t nak[2] = {f.op, FERR_LENGTH};
+      usbSendFrame(OP_NAK, nak, 2);
+      return;
+    }
+    unpackPinString(f.data, text);
+    handleUsbMessage("PINS:" + String(text));
+    break;
+  case OP_EXIT:
+    usbBinary = false;
+    break;
+  default:
+  {
+    uint8_t nak[2] = {f.op, FERR_UNKNOWN_OP};
+    usbSendFrame(OP_NAK, nak, 2);
+    return;
+  }
+  }
+  uint8_t op = f.op;
+  usbSendFrame(OP_ACK, &op, 1);
+}
+
+void usbTask(void *)
+{
+  String buf, line;
+  unsigned long lastRx = 0;
+  for (;;)
+  {
+    unsigned long t0 = micros();
+    if (usbBinary)
+    {
+      while (Serial.available())
+      {
+        usbLink.rxBytes++;
+        if (usbFrameRx.feed(Serial.read()))
+        {
+          usbLink.rxMsgs++;
+          handleUsbFrame(usbFrameRx.frame);
+        }
+      }
+    }
+    else
+    {
+      while (assembleLine(Serial, buf, lastRx, line))
+      {
+        usbLink.rx(line.length() + 1);
+        handleUsbMessage(line);
+      }
+    }
+
+    BridgeMsg m;
+    while (nextionToUsb.pop(m))
+      usbSendLine(m.text);
+    while (bleToUsb.pop(m))
+      usbSendLine(m.text);
+
+    usbLoop.record(micros() - t0);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LINE_IDLE_MS));
+  }
+}
+
+// --- Nextion (nextionTask) ---
+
+// Component state the display already shows is not written again; the rest
+// is collected per pass and leaves in one UART write (see DisplayCache.h).
+DisplayCache nextionCache;
+uint8_t nextionBatch[NEXTION_BATCH_MAX];
+int nextionBatchLen = 0;
+unsigned long lastRefresh = 0;
+
+void flushNextion()
+{
+  if (!nextionBatchLen)
+    return;
+  SerialNextion.write(nextionBatch, nextionBatchLen);
+  nextionBatchLen = 0;
+}
+
+// Queues one command and its terminator for the next flushNextion()
+void batchToNextion(const String &command)
+{
+  int n = command.length() + 3;
+  if (n > NEXTION_BATCH_MAX)
+    return;
+  if (nextionBatchLen + n > NEXTION_BATCH_MAX)
+    flushNextion();
+  memcpy(nextionBatch + nextionBatchLen, command.c_str(), command.length());
+  memset(nextionBatch + nextionBatchLen + command.length(), 0xFF, 3);
+  nextionBatchLen += n;
+  nextionLink.tx(n);
+}
+
+// Component state: skipped when unchanged
+void showOnNextion(const String &command)
+{
+  if (nextionCache.update(command.c_str(), command.length()))
+    batchToNextion(command);
+}
+
+// Immediate write, for the baud handshake
+void sendToNextion(const String &command)
+{
+  batchToNextion(command);
+  flushNextion();
+}
+
+// --- Nextion baud negotiation (setup, before the tasks start) ---
+
+void nextionOpen(unsigned long baud)
+{
+  SerialNextion.flush();
+  SerialNextion.updateBaudRate(baud);
+  nextionBaud = baud;
+}
+
+// "sendme" is answered with 66 <page> FF FF FF whatever bkcmd is set to. The
+// leading terminator flushes any half command the display still holds.
+bool nextionProbe()
+{
+  while (SerialNextion.available())
+    SerialNextion.read();
+  sendToNextion("");
+  sendToNextion("sendme");
+  int n = 0;
+  for (int ms = 0; ms < NEXTION_PROBE_MS; ms++)
+  {
+    while (SerialNextion.available())
+    {
+      uint8_t c = SerialNextion.read();
+      if (n == 0 && c != 0x66)
+        continue;
+      if (n >= 2 && c != 0xFF)
+      {
+        n = 0;
+        continue;
+      }
+      if (++n == 5)
+        return true;
+    }
+    delay(1);
+  }
+  return false;
+}
+
+// Moves the display off its 9600 baud power-on rate: baud=<target>, follow,
+// verify with sendme, and fall back to 9600 if the display does not answer.
+// Returns the verified rate, or 0 if no display answered at all.
+unsigned long negotiateNextionBaud(unsigned long target)
+{
+  nextionCache.clear();
+  // baud= lasts until the display is power-cycled, so after a bridge reset
+  // it is usually still at the target rate.
+  if (target != NEXTION_BAUD_DEFAULT)
+  {
+    nextionOpen(target);
+    if (nextionProbe())
+      return target;
+  }
+  nextionOpen(NEXTION_BAUD_DEFAULT);
+  bool present = nextionProbe();
+  if (!present || target == NEXTION_BAUD_DEFAULT)
+    return present ? NEXTION_BAUD_DEFAULT : 0;
+
+  sendToNextion("baud=" + String(target));
+  SerialNextion.flush();
+  delay(NEXTION_SWITCH_MS);
+  nextionOpen(target);
+  if (nextionProbe())
+    return target;
+
+  // The display may have switched without us hearing it; ask it back.
+  sendToNextion("baud=" + String(NEXTION_BAUD_DEFAULT));
+  SerialNextion.flush();
+  delay(NEXTION_SWITCH_MS);
+  nextionOpen(NEXTION_BAUD_DEFAULT);
+  return nextionProbe() ? NEXTION_BAUD_DEFAULT : 0;
+}
+
+void handleNextionMessage(const String &msg)
+{
+  if (msg == "BLE:ON" || msg == "BLE:OFF")
+  {
+    post(nextionToBle, bleTaskHandle, msg);
+  }
+  else if (msg.startsWith("IC:"))
+  {
+    String ic = msg.substring(3);
+    post(nextionToUsb, usbTaskHandle, "IC:" + ic);
+    showOnNextion("t0.txt=\"" + ic + "\"");
+    post(nextionToBle, bleTaskHandle, msg);
+  }
+  else if (msg.startsWith("PINS:"))
+  {
+    // Forward to BLE and Serial
+    post(nextionToBle, bleTaskHandle, msg);
+    post(nextionToUsb, usbTaskHandle, msg);
+
+    // Update IcVisualiser
+    showOnNextion("IcVisualiser.t1.txt=\"" + msg.substring(5) + "\"");
+  }
+  else if (msg.startsWith("CLOCK:PULSE") || msg.startsWith("RESTART"))
+  {
+    if (msg.startsWith("RESTART"))
+      nextionCache.clear();
+    // Forward to BLE and Serial
+    post(nextionToBle, bleTaskHandle, msg);
+    post(nextionToUsb, usbTaskHandle, msg);
+  }
+}
+
+void nextionTask(void *)
+{
+  String buf, line;
+  unsigned long lastRx = 0;
+  for (;;)
+  {
+    unsigned long t0 = micros();
+    while (assembleLine(SerialNextion, buf, lastRx, line))
+    {
+      nextionLink.rx(line.length() + 1);
+      handleNextionMessage(line);
+    }
+
+    if (millis() - lastRefresh >= NEXTION_REFRESH_MS)
+    {
+      nextionCache.clear();
+      lastRefresh = millis();
+    }
+
+    BridgeMsg m;
+    while (usbToNextion.pop(m))
+      showOnNextion(m.text);
+    while (bleToNextion.pop(m))
+      showOnNextion(m.text);
+    flushNextion();
+
+    nextionLoop.record(micros() - t0);
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LINE_IDLE_MS));
+  }
+}
+
+// --- BLE (bleTask and BLE stack callbacks) ---
+
+// Pin sample stream. Every PINS:/PD: update becomes a 16-bit sample (bit j =
+// pin string char j) and samples are packed into one notification:
+//   seq u8, count u8, t0 ms u32 LE, count x (dt ms u16 LE, pins u16 LE)
+// with dt relative to t0. Times are the tester's: a PD: sample carries the
+// <ms> the tester stamped it with, and a PINS: sample (which has none) gets
+// the bridge's clock shifted by the offset seen on the last PD: line. A packet goes out when it fills the negotiated MTU,
+// when STREAM_FLUSH_MS have passed since its first sample, or when dt would
+// overflow. seq lets the client spot lost packets.
+#define STREAM_MTU 247 // fits one LE data length extension packet
+#define STREAM_HEADER 6
+#define STREAM_SAMPLE 4
+#define STREAM_FLUSH_MS 20
 
 class MyServerCallbacks : public BLEServerCallbacks
 {
   void onConnect(BLEServer *pServer)
   {
     deviceConnected = true;
-    Serial.println("BLE Device Connected");
+    post(bleInbox, bleTaskHandle, "CONNECT");
   };
 
   void onDisconnect(BLEServer *pServer)
   {
     deviceConnected = false;
-    Serial.println("BLE Device Disconnected");
+    post(bleInbox, bleTaskHandle, "DISCONNECT");
   }
 };
 
@@ -51,29 +502,23 @@ class PinsCharCallbacks : public BLECharacteristicCallbacks
   {
     std::string value = pCharacteristic->getValue();
     if (value.length() > 0)
-    {
-      String pinData = String(value.c_str());
-      // Forward to Nextion and Serial
-      SerialNextion.print("PINS:" + pinData);
-      SerialNextion.write(0xFF);
-      SerialNextion.write(0xFF);
-      SerialNextion.write(0xFF);
-      Serial.println("PINS:" + pinData);
-    }
+      post(bleInbox, bleTaskHandle, "PINS:" + String(value.c_str()));
   }
 };
 
-void sendToNextion(String command)
+class ClockCharCallbacks : public BLECharacteristicCallbacks
 {
-  SerialNextion.print(command);
-  SerialNextion.write(0xFF);
-  SerialNextion.write(0xFF);
-  SerialNextion.write(0xFF);
-}
+  void onWrite(BLECharacteristic *pCharacteristic)
+  {
+    post(bleInbox, bleTaskHandle, "FREQ:" + String(pCharacteristic->getValue().c_str()));
+  }
+};
 
 void startBLEServer()
 {
   BLEDevice::init("ESP32-IC-Tester");
+  // Offer a large ATT MTU; the central picks the final value on connect
+  BLEDevice::setMTU(STREAM_MTU);
   pServer = BLEDevice::createServer();
   pServer->setCallbacks(new MyServerCallbacks());
 
@@ -98,6 +543,7 @@ void startBLEServer()
       CLOCK_CHAR_UUID,
       BLECharacteristic::PROPERTY_READ |
           BLECharacteristic::PROPERTY_WRITE);
+  pClockChar->setCallbacks(new ClockCharCallbacks());
 
   // Status Characteristic (Notify Only)
   pStatusChar = pService->createCharacteristic(
@@ -105,6 +551,12 @@ void startBLEServer()
       BLECharacteristic::PROPERTY_NOTIFY);
   pStatusChar->addDescriptor(new BLE2902());
 
+  // Stream Characteristic (Notify Only): batched binary pin samples
+  pStreamChar = pService->createCharacteristic(
+      STREAM_CHAR_UUID,
+      BLECharacteristic::PROPERTY_NOTIFY);
+  pStreamChar->addDescriptor(new BLE2902());
+
   pService->start();
   BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
   pAdvertising->addServiceUUID(SERVICE_UUID);
@@ -113,7 +565,7 @@ void startBLEServer()
   pAdvertising->setMinPreferred(0x12);
   BLEDevice::startAdvertising();
   bleEnabled = true;
-  Serial.println("BLE Server Started");
+  post(bleToUsb, usbTaskHandle, "BLE Server Started");
 }
 
 void stopBLEServer()
@@ -124,144 +576,327 @@ void stopBLEServer()
   }
   BLEDevice::deinit();
   bleEnabled = false;
-  Serial.println("BLE Server Stopped");
+  readvertiseAt = 0;
+  post(bleToUsb, usbTaskHandle, "BLE Server Stopped");
 }
 
-void setup()
+void bleNotify(BLECharacteristic *c, size_t len)
 {
-  Serial.begin(115200);
-  SerialNextion.begin(9600, SERIAL_8N1, NEXTION_RX, NEXTION_TX);
-  Serial.println("Device Initialized");
+  c->notify();
+  bleLink.tx(len);
 }
 
-void loop()
+// Splits at ':' field boundaries when the line does not fit one notification
+void notifyStatus(const String &status)
 {
-  // Handle Nextion UART
-  if (SerialNextion.available())
+  // 0 for a connection that has just gone away; never split below the
+  // default ATT MTU of 23 or the loop below would not advance.
+  uint16_t mtu = pServer->getPeerMTU(pServer->getConnId());
+  if (mtu < 23)
+    mtu = 23;
+  int room = mtu - 3;
+  int start = 0;
+  while ((int)status.length() - start > room)
   {
-    String msg = SerialNextion.readStringUntil('\n');
-    msg.trim();
+    int cut = start + room;
+    while (cut > start && status.charAt(cut) != ':')
+      cut--;
+    if (cut == start)
+      cut = start + room;
+    String part = status.substring(start, cut);
+    pStatusChar->setValue(part.c_str());
+    bleNotify(pStatusChar, part.length());
+    start = status.charAt(cut) == ':' ? cut + 1 : cut;
+  }
+  pStatusChar->setValue(status.c_str() + start);
+  bleNotify(pStatusChar, status.length() - start);
+}
 
-    if (msg == "BLE:ON" && !bleEnabled)
-    {
-      startBLEServer();
-    }
-    else if (msg == "BLE:OFF" && bleEnabled)
-    {
-      stopBLEServer();
-    }
-    else if (msg.startsWith("IC:"))
-    {
-      currentIC = msg.substring(3);
-      Serial.println("IC:" + currentIC);
-      sendToNextion("t0.txt=\"" + currentIC + "\"");
+// Pin sample stream state (bleTask)
+uint8_t streamBuf[STREAM_MTU - 3];
+uint8_t streamCount = 0;
+uint8_t streamSeq = 0;
+uint32_t streamStart = 0; // t0 of the packet being filled
+uint32_t testerClockOffset = 0; // tester ms - bridge ms, as of the last PD: line
+unsigned long streamOpened = 0;
 
-      // Update BLE if connected
-      if (bleEnabled && deviceConnected)
-      {
-        pICChar->setValue(currentIC.c_str());
-      }
-    }
-    else if (msg.startsWith("PINS:"))
-    {
-      // Forward to BLE and Serial
-      String pinData = msg.substring(5);
-      if (bleEnabled && deviceConnected)
-      {
-        pPinsChar->setValue(pinData.c_str());
-        pPinsChar->notify();
-      }
-      Serial.println(msg);
+// Samples per notification for the current connection's MTU
+uint8_t streamCapacity()
+{
+  uint16_t mtu = pServer->getPeerMTU(pServer->getConnId());
+  if (mtu < 23 || mtu > STREAM_MTU)
+    mtu = mtu < 23 ? 23 : STREAM_MTU;
+  return (mtu - 3 - STREAM_HEADER) / STREAM_SAMPLE;
+}
 
-      // Update IcVisualiser
-      String binary = "";
-      for (int i = 0; i < pinData.length(); i++)
-      {
-        if (pinData.charAt(i) == '1')
-        {
-          binary += "1";
-        }
-        else
-        {
-          binary += "0";
-        }
-      }
-      sendToNextion("IcVisualiser.t1.txt=\"" + binary + "\"");
-    }
-    else if (msg.startsWith("CLOCK:PULSE"))
-    {
-      // Forward to BLE
-      if (bleEnabled && deviceConnected)
-      {
-        pClockChar->setValue(msg.c_str());
-        pClockChar->notify();
-      }
-      Serial.println(msg);
-    }
-    else if (msg.startsWith("RESTART"))
+void streamFlush()
+{
+  if (!streamCount)
+    return;
+  streamBuf[0] = streamSeq++;
+  streamBuf[1] = streamCount;
+  for (uint8_t i = 0; i < 4; i++)
+    streamBuf[2 + i] = streamStart >> (8 * i);
+  pStreamChar->setValue(streamBuf, STREAM_HEADER + streamCount * STREAM_SAMPLE);
+  bleNotify(pStreamChar, STREAM_HEADER + streamCount * STREAM_SAMPLE);
+  streamCount = 0;
+}
+
+void streamSample(uint32_t ms, uint16_t pins)
+{
+  if (streamCount && (ms - streamStart > 0xFFFF || streamCount >= streamCapacity()))
+    streamFlush();
+  if (!streamCount)
+  {
+    streamStart = ms;
+    streamOpened = millis();
+  }
+  uint16_t dt = ms - streamStart;
+  uint8_t *p = streamBuf + STREAM_HEADER + streamCount++ * STREAM_SAMPLE;
+  p[0] = dt;
+  p[1] = dt >> 8;
+  p[2] = pins;
+  p[3] = pins >> 8;
+  if (streamCount >= streamCapacity())
+    streamFlush();
+}
+
+// Clock frequency writes (integer Hz, 0 = stop) are passed on to the tester
+// as CLOCK:FREQ:<hz>; the tester's clock engine tops out at 10 kHz.
+#define CLOCK_MAX_HZ 10000
+
+void handleClockWrite(String value)
+{
+  value.trim();
+  bool valid = value.length() > 0;
+  for (unsigned int i = 0; i < value.length(); i++)
+  {
+    if (!isDigit(value.charAt(i)))
+      valid = false;
+  }
+  long hz = value.toInt();
+  if (!valid || hz > CLOCK_MAX_HZ)
+  {
+    notifyStatus("ERROR:INVALID_FREQUENCY");
+    return;
+  }
+  post(bleToUsb, usbTaskHandle, "CLOCK:FREQ:" + String(hz));
+  notifyStatus("OK:CLOCK:" + String(hz));
+}
+
+// Events raised by the BLE stack callbacks
+void handleBleEvent(const String &msg)
+{
+  if (msg == "CONNECT")
+  {
+    post(bleToUsb, usbTaskHandle, "BLE Device Connected");
+  }
+  else if (msg == "DISCONNECT")
+  {
+    post(bleToUsb, usbTaskHandle, "BLE Device Disconnected");
+    // Give the stack time to settle before advertising again
+    readvertiseAt = millis() + READVERTISE_MS;
+  }
+  else if (msg.startsWith("PINS:"))
+  {
+    bleLink.rx(msg.length() - 5);
+    post(bleToNextion, nextionTaskHandle, msg);
+    post(bleToUsb, usbTaskHandle, msg);
+  }
+  else if (msg.startsWith("FREQ:"))
+  {
+    bleLink.rx(msg.length() - 5);
+    handleClockWrite(msg.substring(5));
+  }
+}
+
+// Messages from the other transports
+void handleBleMessage(const String &msg, uint32_t ms)
+{
+  if (msg == "BLE:ON" && !bleEnabled)
+  {
+    startBLEServer();
+    return;
+  }
+  if (msg == "BLE:OFF" && bleEnabled)
+  {
+    stopBLEServer();
+    return;
+  }
+  if (!bleEnabled || !deviceConnected)
+    return;
+  if (msg.startsWith("IC:"))
+  {
+    pICChar->setValue(msg.c_str() + 3);
+  }
+  else if (msg.startsWith("PINS:"))
+  {
+    pPinsChar->setValue(msg.c_str() + 5);
+    bleNotify(pPinsChar, msg.length() - 5);
+    uint16_t pins = 0;
+    for (unsigned int i = 5; i < msg.length() && i < 21; i++)
     {
-      // Forward to BLE
-      if (bleEnabled && deviceConnected)
-      {
-        pClockChar->setValue(msg.c_str());
-        pClockChar->notify();
-      }
-      Serial.println(msg);
+      if (msg.charAt(i) == '1')
+        pins |= 1u << (i - 5);
     }
+    streamSample(ms + testerClockOffset, pins);
+  }
+  else if (msg.startsWith("PD:"))
+  {
+    // PD:<ms>:<changed>:<value>, ms in decimal on the tester's clock, value
+    // already in pin string bits
+    char *end;
+    uint32_t testerMs = strtoul(msg.c_str() + 3, &end, 10);
+    int sep = msg.lastIndexOf(':');
+    if (*end != ':' || sep <= end - msg.c_str())
+      return;
+    testerClockOffset = testerMs - ms;
+    streamSample(testerMs, strtoul(msg.c_str() + sep + 1, NULL, 16));
+  }
+  else if (msg.startsWith("CLOCK:PULSE") || msg.startsWith("RESTART"))
+  {
+    pClockChar->setValue(msg.c_str());
+    bleNotify(pClockChar, msg.length());
   }
+}
 
-  // Handle USB Serial
-  if (Serial.available())
+void bleTask(void *)
+{
+  unsigned long lastStatusUpdate = 0;
+  for (;;)
   {
-    String msg = Serial.readStringUntil('\n');
-    msg.trim();
+    unsigned long t0 = micros();
+    BridgeMsg m;
+    while (bleInbox.pop(m))
+      handleBleEvent(m.text);
+    while (nextionToBle.pop(m))
+      handleBleMessage(m.text, m.ms);
+    while (usbToBle.pop(m))
+      handleBleMessage(m.text, m.ms);
 
-    if (msg.startsWith("IC:"))
-    {
-      currentIC = msg.substring(3);
-      Serial.println("IC:" + currentIC);
+    if (!deviceConnected)
+      streamCount = 0;
+    else if (streamCount && millis() - streamOpened >= STREAM_FLUSH_MS)
+      streamFlush();
 
-      // Update Nextion and BLE
-      sendToNextion("t0.txt=\"" + currentIC + "\"");
-      if (bleEnabled && deviceConnected)
-      {
-        pICChar->setValue(currentIC.c_str());
-      }
+    if (bleEnabled && readvertiseAt && (long)(millis() - readvertiseAt) >= 0)
+    {
+      readvertiseAt = 0;
+      if (!deviceConnected)
+        pServer->startAdvertising();
     }
-    else if (msg.startsWith("PINS:"))
+
+    // Send status and telemetry to BLE (every 5 seconds)
+    if (bleEnabled && deviceConnected && millis() - lastStatusUpdate >= STATUS_INTERVAL_MS)
     {
-      // Forward to Nextion and BLE
-      sendToNextion(msg);
-      if (bleEnabled && deviceConnected)
-      {
-        String pinData = msg.substring(5);
-        pPinsChar->setValue(pinData.c_str());
-        pPinsChar->notify();
-      }
+      notifyStatus(statusLine());
+      lastStatusUpdate = millis();
     }
+
+    bleLoop.record(micros() - t0);
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(streamCount ? STREAM_FLUSH_MS : 100));
   }
+}
+
+// --- Telemetry ---
+
+struct RingInfo
+{
+  const char *name;
+  MsgRing *ring;
+};
+static const RingInfo rings[] = {
+    {"NX>USB", &nextionToUsb}, {"NX>BLE", &nextionToBle},
+    {"USB>NX", &usbToNextion}, {"USB>BLE", &usbToBle},
+    {"BLE>NX", &bleToNextion}, {"BLE>USB", &bleToUsb},
+    {"BLE.IN", &bleInbox}};
 
-  // Handle BLE Connection Status
-  if (!deviceConnected && oldDeviceConnected)
+// STATS:UP=<ms>
+// STATS:LOOP:<task>:<n0>,...,<n5>:MAX=<us>   (buckets <64,<256,<1024,<4096,<16384 us, longer)
+// STATS:<link>:RX=<bytes>/<msgs>:TX=<bytes>/<msgs>   (NEXTION adds :SKIP=<n>:BAUD=<rate>)
+// STATS:QUEUE:<ring>=<depth>/<peak>,...     (capacity RING_SIZE)
+// STATS:DROP=<n>:TRUNC=<n>
+// STATS:HEAP=<free>:MIN=<lowest free>
+// STATS:DONE
+// STATS:CLEAR zeroes the histograms and link counters.
+void handleStats(const String &cmd)
+{
+  if (cmd == "STATS:CLEAR")
+  {
+    usbLoop.clear();
+    nextionLoop.clear();
+    bleLoop.clear();
+    usbLink.clear();
+    nextionLink.clear();
+    bleLink.clear();
+    usbSendLine("OK:STATS");
+    return;
+  }
+  char buf[64];
+  usbSendLine("STATS:UP=" + String(millis()));
+  const LoopHistogram *loops[] = {&usbLoop, &nextionLoop, &bleLoop};
+  const LinkCounters *links[] = {&usbLink, &nextionLink, &bleLink};
+  const char *names[] = {"USB", "NEXTION", "BLE"};
+  for (int i = 0; i < 3; i++)
   {
-    delay(500);
-    pServer->startAdvertising();
-    oldDeviceConnected = deviceConnected;
+    loops[i]->format(buf, sizeof(buf));
+    usbSendLine(String("STATS:LOOP:") + names[i] + ":" + buf);
   }
-  if (deviceConnected && !oldDeviceConnected)
+  for (int i = 0; i < 3; i++)
   {
-    oldDeviceConnected = deviceConnected;
+    links[i]->format(buf, sizeof(buf));
+    String extra = links[i] == &nextionLink
+                       ? ":SKIP=" + String(nextionCache.suppressed) + ":BAUD=" + String(nextionBaud)
+                       : String();
+    usbSendLine(String("STATS:") + names[i] + ":" + buf + extra);
   }
+  String q = "STATS:QUEUE:";
+  for (size_t i = 0; i < sizeof(rings) / sizeof(rings[0]); i++)
+  {
+    if (i)
+      q += ",";
+    q += String(rings[i].name) + "=" + String(rings[i].ring->size()) + "/" + String(rings[i].ring->highWater());
+  }
+  usbSendLine(q);
+  usbSendLine("STATS:DROP=" + String(droppedMsgs) + ":TRUNC=" + String(truncatedMsgs));
+  usbSendLine("STATS:HEAP=" + String(ESP.getFreeHeap()) + ":MIN=" + String(ESP.getMinFreeHeap()));
+  usbSendLine("STATS:DONE");
+}
 
-  // Send status updates to BLE (every 5 seconds)
-  static unsigned long lastStatusUpdate = 0;
-  if (bleEnabled && deviceConnected && millis() - lastStatusUpdate >= 5000)
+// STATUS:OK:HEAP=<free>:DROP=<n>:TRUNC=<n>:LOOP=<usb>/<nextion>/<ble> max us:Q=<deepest ring peak>
+String statusLine()
+{
+  uint16_t peak = 0;
+  for (size_t i = 0; i < sizeof(rings) / sizeof(rings[0]); i++)
   {
-    const char *status = "STATUS:OK";
-    pStatusChar->setValue(status);
-    pStatusChar->notify();
-    lastStatusUpdate = millis();
+    if (rings[i].ring->highWater() > peak)
+      peak = rings[i].ring->highWater();
   }
+  return "STATUS:OK:HEAP=" + String(ESP.getFreeHeap()) +
+         ":DROP=" + String(droppedMsgs) + ":TRUNC=" + String(truncatedMsgs) +
+         ":LOOP=" + String(usbLoop.maxUs()) + "/" + String(nextionLoop.maxUs()) + "/" + String(bleLoop.maxUs()) +
+         ":Q=" + String(peak);
+}
 
-  delay(10);
-}
\ No newline at end of file
+void setup()
+{
+  Serial.begin(115200);
+  SerialNextion.begin(NEXTION_BAUD_DEFAULT, SERIAL_8N1, NEXTION_RX, NEXTION_TX);
+  unsigned long baud = negotiateNextionBaud(NEXTION_TARGET_BAUD);
+  Serial.println("NEXTION:BAUD:" + (baud ? String(baud) : String("NO_REPLY")));
+  Serial.println("Device Initialized");
+
+  xTaskCreatePinnedToCore(usbTask, "usb", 4096, NULL, 2, &usbTaskHandle, 1);
+  xTaskCreatePinnedToCore(nextionTask, "nextion", 4096, NULL, 2, &nextionTaskHandle, 1);
+  xTaskCreatePinnedToCore(bleTask, "ble", 8192, NULL, 2, &bleTaskHandle, 0);
+  // Wake the transport tasks as soon as bytes arrive instead of on their poll
+  Serial.onReceive([]() { xTaskNotifyGive(usbTaskHandle); });
+  SerialNextion.onReceive([]() { xTaskNotifyGive(nextionTaskHandle); });
+}
+
+void loop()
+{
+  // Everything runs in the transport tasks
+  vTaskDelete(NULL);
+}
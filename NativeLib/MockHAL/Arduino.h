@@ -0,0 +1,250 @@
+#pragma once
+// Minimal Arduino core for native (host) builds of the tester firmware.
+// Only what the firmware uses is provided; see MockHAL.h for the hooks the
+// run/benchmark harness uses to drive it.
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+#define SERIAL_8N1   0x06
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(p)  (*(const uint8_t *)(p))
+#define pgm_read_word(p)  (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p)   (*(void *const *)(p))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strlen_P strlen
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class String {
+ public:
+  String() {}
+  String(const char *c) : s(c ? c : "") {}
+  String(const std::string &c) : s(c) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = DEC) { fmt(v, base); }
+  String(unsigned v, unsigned char base = DEC) { fmtu(v, base); }
+  String(long v, unsigned char base = DEC) { fmt(v, base); }
+  String(unsigned long v, unsigned char base = DEC) { fmtu(v, base); }
+  String(unsigned char v, unsigned char base = DEC) { fmtu(v, base); }
+  String(double v, unsigned char digits = 2) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", digits, v);
+    s = b;
+  }
+
+  unsigned length() const { return s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  bool reserve(unsigned n) { s.reserve(n); return true; }
+  char charAt(unsigned i) const { return i < s.size() ? s[i] : 0; }
+  char operator[](unsigned i) const { return charAt(i); }
+  char &operator[](unsigned i) { return s[i]; }
+  void setCharAt(unsigned i, char c) { if (i < s.size()) s[i] = c; }
+  String substring(unsigned from) const { return from >= s.size() ? String() : String(s.substr(from)); }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.size()) return String();
+    return String(s.substr(from, std::min<size_t>(to, s.size()) - from));
+  }
+  bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  bool endsWith(const String &p) const {
+    return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const String &c, unsigned from = 0) const { return pos(s.find(c.s, from)); }
+  int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+  void trim() {
+    size_t a = s.find_first_not_of(" \t\r\n\v\f");
+    if (a == std::string::npos) { s.clear(); return; }
+    s = s.substr(a, s.find_last_not_of(" \t\r\n\v\f") - a + 1);
+  }
+  void toUpperCase() { for (auto &c : s) c = toupper(c); }
+  void toLowerCase() { for (auto &c : s) c = tolower(c); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  bool equals(const String &o) const { return s == o.s; }
+  bool equalsIgnoreCase(const String &o) const {
+    return s.size() == o.s.size() && std::equal(s.begin(), s.end(), o.s.begin(),
+        [](char a, char b) { return tolower(a) == tolower(b); });
+  }
+  void remove(unsigned i) { if (i < s.size()) s.erase(i); }
+  void remove(unsigned i, unsigned n) { if (i < s.size()) s.erase(i, n); }
+  void replace(const String &a, const String &b) {
+    if (a.s.empty()) return;
+    for (size_t p = 0; (p = s.find(a.s, p)) != std::string::npos; p += b.s.size()) s.replace(p, a.s.size(), b.s);
+  }
+
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  String &operator+=(char c) { s += c; return *this; }
+  String &operator+=(int v) { return *this += String(v); }
+  String &operator+=(unsigned v) { return *this += String(v); }
+  String &operator+=(long v) { return *this += String(v); }
+  String &operator+=(unsigned long v) { return *this += String(v); }
+  bool concat(const String &o) { s += o.s; return true; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator==(const char *o) const { return s == (o ? o : ""); }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator!=(const char *o) const { return !(*this == o); }
+  bool operator<(const String &o) const { return s < o.s; }
+
+  std::string::const_iterator begin() const { return s.begin(); }
+  std::string::const_iterator end() const { return s.end(); }
+
+ private:
+  std::string s;
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fmt(long v, unsigned char base) {
+    if (v < 0 && base == DEC) { fmtu((unsigned long)-v, base); s.insert(0, 1, '-'); }
+    else fmtu((unsigned long)v, base);
+  }
+  void fmtu(unsigned long v, unsigned char base) {
+    char b[72];
+    int i = sizeof(b) - 1;
+    b[i] = 0;
+    do { unsigned d = v % base; b[--i] = d < 10 ? '0' + d : 'A' + d - 10; v /= base; } while (v);
+    s = b + i;
+  }
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, int b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, unsigned long b) { String r(a); r += b; return r; }
+inline bool operator==(const char *a, const String &b) { return b == a; }
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+  }
+  size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+  size_t write(const char *buf, size_t n) { return write((const uint8_t *)buf, n); }
+
+  size_t print(const String &v) { return write((const uint8_t *)v.c_str(), v.length()); }
+  size_t print(const char *v) { return write(v); }
+  size_t print(char v) { return write((uint8_t)v); }
+  size_t print(unsigned char v, int base = DEC) { return print(String(v, base)); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int digits = 2) { return print(String(v, digits)); }
+
+  size_t println() { return write("\r\n"); }
+  template <class T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  template <class T> size_t println(const T &v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  unsigned long getTimeout() const { return timeout; }
+  size_t readBytes(uint8_t *buf, size_t n);
+  size_t readBytes(char *buf, size_t n) { return readBytes((uint8_t *)buf, n); }
+  String readString();
+  String readStringUntil(char terminator);
+ protected:
+  unsigned long timeout = 1000;
+  int timedRead();
+};
+
+// UART with a byte-accurate model of the TX FIFO: bytes drain at the
+// configured baud rate in virtual time and write() blocks (advancing the
+// clock) when the FIFO is full, as on the real cores.
+class HardwareSerial : public Stream {
+ public:
+  explicit HardwareSerial(int uartNr = 0);
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1,
+             bool invert = false, unsigned long timeoutMs = 20000UL);
+  void end() {}
+  void updateBaudRate(unsigned long b) { drain(); baud = b; }
+  unsigned long baudRate() const { return baud; }
+  int available() override;
+  int availableForWrite();
+  int read() override;
+  int peek() override;
+  void flush();
+  using Print::write;
+  size_t write(uint8_t c) override;
+  operator bool() const { return true; }
+  // ESP32 core: called when bytes arrive (here: on every inject()).
+  void onReceive(std::function<void()> cb, bool onlyOnTimeout = false) { rxCallback = cb; }
+
+  // Harness side
+  int uart() const { return uartNr; }
+  void inject(const std::string &bytes) { rx += bytes; if (rxCallback) rxCallback(); }
+  std::string &output() { return tx; }
+  unsigned long bytesWritten() const { return written; }
+  static HardwareSerial *byUart(int nr);
+
+ private:
+  int uartNr;
+  unsigned long baud = 115200;
+  std::string rx, tx;
+  unsigned long written = 0;
+  bool begun = false;
+  std::function<void()> rxCallback;
+  double fifo = 0;            // bytes still on the wire
+  uint64_t drainedAt = 0;     // virtual us of the last drain
+  void drain();
+};
+
+extern HardwareSerial Serial, Serial1, Serial2, Serial3;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline bool isDigit(int c) { return isdigit(c); }
+inline bool isAlpha(int c) { return isalpha(c); }
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// ESP32 core heap figures; the host has no fixed heap, so these are constants.
+class EspClass {
+ public:
+  uint32_t getFreeHeap() { return 200000; }
+  uint32_t getMinFreeHeap() { return 180000; }
+  uint32_t getHeapSize() { return 320000; }
+};
+extern EspClass ESP;
+
+void setup();
+void loop();
@@ -0,0 +1,122 @@
+#pragma once
+// ESP32 BLE stand-ins: characteristics keep their value and count notify()
+// traffic; the harness can play the central through MockHAL.h.
+#include <Arduino.h>
+#include <string>
+
+class BLEServer;
+class BLECharacteristic;
+
+class BLEDescriptor {
+ public:
+  virtual ~BLEDescriptor() {}
+};
+class BLE2902 : public BLEDescriptor {};
+
+class BLECharacteristicCallbacks {
+ public:
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onRead(BLECharacteristic *) {}
+  virtual void onWrite(BLECharacteristic *) {}
+};
+
+class BLEServerCallbacks {
+ public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer *) {}
+  virtual void onDisconnect(BLEServer *) {}
+};
+
+class BLEUUID {
+ public:
+  BLEUUID(const char *s = "") : str(s) {}
+  std::string toString() const { return str; }
+ private:
+  std::string str;
+};
+
+class BLECharacteristic {
+ public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+  static const uint32_t PROPERTY_INDICATE = 1 << 3;
+  static const uint32_t PROPERTY_WRITE_NR = 1 << 4;
+
+  BLECharacteristic(const char *uuid = "", uint32_t props = 0) : uuid(uuid), properties(props) {}
+  void setValue(const std::string &v) { value = v; }
+  void setValue(const char *v) { value = v; }
+  void setValue(uint8_t *data, size_t n) { value.assign((const char *)data, n); }
+  void setValue(uint16_t v) { value.assign((const char *)&v, 2); }
+  void setValue(uint32_t v) { value.assign((const char *)&v, 4); }
+  std::string getValue() { return value; }
+  BLEUUID getUUID() { return uuid; }
+  void notify(bool = true) { notifies++; notifyBytes += value.size(); }
+  void indicate() { notify(); }
+  void setCallbacks(BLECharacteristicCallbacks *cb) { callbacks = cb; }
+  void addDescriptor(BLEDescriptor *) {}
+
+  // Harness side: a central writing to the characteristic.
+  void centralWrite(const std::string &v) { value = v; if (callbacks) callbacks->onWrite(this); }
+  unsigned long notifies = 0, notifyBytes = 0;
+
+ private:
+  BLEUUID uuid;
+  uint32_t properties;
+  std::string value;
+  BLECharacteristicCallbacks *callbacks = nullptr;
+};
+
+class BLEService {
+ public:
+  BLECharacteristic *createCharacteristic(const char *uuid, uint32_t props);
+  BLECharacteristic *getCharacteristic(const char *uuid);
+  void start() {}
+ private:
+  BLECharacteristic *chars[16];
+  std::string uuids[16];
+  int count = 0;
+};
+
+class BLEServer {
+ public:
+  void setCallbacks(BLEServerCallbacks *cb) { callbacks = cb; }
+  BLEService *createService(const char *) { return &service; }
+  BLEService *getService() { return &service; }
+  void startAdvertising() { advertising = true; }
+  uint16_t getConnId() { return 0; }
+  uint16_t getPeerMTU(uint16_t) { return peerMtu; }
+  void disconnect(uint16_t) { if (callbacks) callbacks->onDisconnect(this); }
+  // Harness side
+  void centralConnect(uint16_t mtu = 23) { peerMtu = mtu; if (callbacks) callbacks->onConnect(this); }
+  bool advertising = false;
+  uint16_t peerMtu = 23;
+ private:
+  BLEServerCallbacks *callbacks = nullptr;
+  BLEService service;
+};
+
+class BLEAdvertising {
+ public:
+  void addServiceUUID(const char *) {}
+  void setScanResponse(bool) {}
+  void setMinPreferred(uint16_t) {}
+  void setMaxPreferred(uint16_t) {}
+  void start() {}
+  void stop() {}
+};
+
+class BLEDevice {
+ public:
+  static void init(const std::string &) { initialised = true; }
+  static void deinit(bool = false) { initialised = false; }
+  static BLEServer *createServer() { return server = new BLEServer(); }
+  static BLEAdvertising *getAdvertising() { static BLEAdvertising a; return &a; }
+  static void startAdvertising() { if (server) server->advertising = true; }
+  static int setMTU(uint16_t m) { localMtu = m; return 0; }
+  static uint16_t getMTU() { return localMtu; }
+  // Harness side
+  static BLEServer *server;
+  static bool initialised;
+  static uint16_t localMtu;
+};
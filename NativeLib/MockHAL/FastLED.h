@@ -0,0 +1,56 @@
+#pragma once
+// FastLED stand-in: colours are stored, show() only counts frames and the
+// time the real WS2812 output would keep interrupts disabled.
+#include <Arduino.h>
+
+struct CRGB {
+  uint8_t r, g, b;
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000, Blue = 0x0000FF, Green = 0x008000, Orange = 0xFFA500,
+    Red = 0xFF0000, White = 0xFFFFFF, Yellow = 0xFFFF00
+  };
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t c) : r(c >> 16), g(c >> 8), b(c) {}
+  CRGB(HTMLColorCode c) : CRGB((uint32_t)c) {}
+  bool operator==(const CRGB &o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB &o) const { return !(*this == o); }
+};
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+template <uint8_t DATA_PIN> class WS2812 {};
+
+// One strip; showLeds() writes only this strip.
+class CLEDController {
+ public:
+  void showLeds(uint8_t brightness = 255);
+  int size() const { return n; }
+  CRGB *leds() { return data; }
+ private:
+  friend class CFastLED;
+  CRGB *data = nullptr;
+  int n = 0;
+};
+
+class CFastLED {
+ public:
+  template <template <uint8_t> class CHIPSET, uint8_t DATA_PIN, EOrder ORDER>
+  CLEDController &addLeds(CRGB *leds, int n) {
+    if (used < 8) { strips[used].data = leds; strips[used].n = n; return strips[used++]; }
+    return strips[7];
+  }
+  void show();
+  void setBrightness(uint8_t) {}
+  int count() const { return used; }
+  CLEDController &operator[](int i) { return strips[i]; }
+  // Harness side: frames shown, strips written (show() counts each strip)
+  unsigned long shows = 0, stripWrites = 0;
+ private:
+  CLEDController strips[8];
+  int used = 0;
+};
+extern CFastLED FastLED;
+
+inline void fill_solid(CRGB *leds, int n, const CRGB &c) {
+  for (int i = 0; i < n; i++) leds[i] = c;
+}
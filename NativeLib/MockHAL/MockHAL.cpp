@@ -0,0 +1,168 @@
+#include "MockHAL.h"
+#include "BLEDevice.h"
+
+#define MOCK_PINS      70
+#define UART_FIFO_SIZE 64
+
+static uint64_t nowUs = 0;
+static uint64_t blockedUs = 0;
+static uint8_t pinLevel[MOCK_PINS];
+static uint8_t pinModes[MOCK_PINS];
+
+static HardwareSerial **registry() {
+  static HardwareSerial *ports[8];
+  return ports;
+}
+static int registered = 0;
+
+HardwareSerial Serial(0), Serial1(1), Serial2(2), Serial3(3);
+EspClass ESP;
+CFastLED FastLED;
+BLEServer *BLEDevice::server = nullptr;
+bool BLEDevice::initialised = false;
+uint16_t BLEDevice::localMtu = 23;
+
+// --- Clock ---
+uint64_t mockNowMicros() { return nowUs; }
+void mockAdvanceMicros(uint64_t us) { nowUs += us; }
+uint64_t mockBlockedMicros() { return blockedUs; }
+void mockClearBlocked() { blockedUs = 0; }
+static void block(uint64_t us) { nowUs += us; blockedUs += us; }
+
+unsigned long millis() { return nowUs / 1000; }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(unsigned long ms) { block((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { block(us); }
+void yield() {}
+
+// --- GPIO ---
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= MOCK_PINS) return;
+  pinModes[pin] = mode;
+  if (mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+}
+void digitalWrite(uint8_t pin, uint8_t val) { if (pin < MOCK_PINS) pinLevel[pin] = val ? HIGH : LOW; }
+int digitalRead(uint8_t pin) { return pin < MOCK_PINS ? pinLevel[pin] : LOW; }
+int analogRead(uint8_t) { return 0; }
+void mockSetPin(uint8_t pin, bool level) { if (pin < MOCK_PINS) pinLevel[pin] = level; }
+bool mockGetPin(uint8_t pin) { return pin < MOCK_PINS && pinLevel[pin]; }
+uint8_t mockPinMode(uint8_t pin) { return pin < MOCK_PINS ? pinModes[pin] : INPUT; }
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+void randomSeed(unsigned long seed) { srand(seed); }
+
+// --- Stream ---
+int Stream::timedRead() {
+  if (available()) return read();
+  block((uint64_t)timeout * 1000);
+  return -1;
+}
+
+size_t Stream::readBytes(uint8_t *buf, size_t n) {
+  size_t i = 0;
+  for (int c; i < n && (c = timedRead()) >= 0;) buf[i++] = c;
+  return i;
+}
+
+// Like the real cores these only return once the timeout has expired with
+// no further data, which is time the firmware spends blocked.
+String Stream::readString() {
+  std::string s;
+  for (int c; (c = timedRead()) >= 0;) s += (char)c;
+  return String(s);
+}
+
+String Stream::readStringUntil(char terminator) {
+  std::string s;
+  for (int c; (c = timedRead()) >= 0 && c != terminator;) s += (char)c;
+  return String(s);
+}
+
+// --- HardwareSerial ---
+HardwareSerial::HardwareSerial(int nr) : uartNr(nr) {
+  if (registered < 8) registry()[registered++] = this;
+}
+
+void HardwareSerial::begin(unsigned long b, uint32_t, int8_t, int8_t, bool, unsigned long) {
+  baud = b;
+  begun = true;
+  drainedAt = nowUs;
+}
+
+void HardwareSerial::drain() {
+  double sent = (double)(nowUs - drainedAt) * baud / 10.0 / 1e6;
+  fifo = fifo > sent ? fifo - sent : 0;
+  drainedAt = nowUs;
+}
+
+int HardwareSerial::available() { return rx.size(); }
+
+int HardwareSerial::availableForWrite() {
+  drain();
+  return UART_FIFO_SIZE - (int)ceil(fifo);
+}
+
+int HardwareSerial::read() {
+  if (rx.empty()) return -1;
+  int c = (uint8_t)rx[0];
+  rx.erase(0, 1);
+  return c;
+}
+
+int HardwareSerial::peek() { return rx.empty() ? -1 : (uint8_t)rx[0]; }
+
+void HardwareSerial::flush() {
+  drain();
+  block((uint64_t)ceil(fifo * 10e6 / baud));
+  drain();
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  drain();
+  if (fifo >= UART_FIFO_SIZE) {
+    block((uint64_t)ceil((fifo - UART_FIFO_SIZE + 1) * 10e6 / baud));
+    drain();
+  }
+  fifo += 1;
+  tx += (char)c;
+  written++;
+  return 1;
+}
+
+HardwareSerial *HardwareSerial::byUart(int nr) {
+  HardwareSerial *found = nullptr;
+  for (int i = 0; i < registered; i++) {
+    HardwareSerial *p = registry()[i];
+    if (p->uartNr != nr) continue;
+    if (!found || p->begun) found = p;  // prefer the object the firmware began
+  }
+  return found;
+}
+
+int mockSerialCount() { return registered; }
+HardwareSerial *mockSerialAt(int i) { return i < registered ? registry()[i] : nullptr; }
+
+// --- FastLED ---
+void CFastLED::show() {
+  shows++;
+  for (int i = 0; i < used; i++) strips[i].showLeds();
+}
+
+void CLEDController::showLeds(uint8_t) {
+  FastLED.stripWrites++;
+  block(30 * n + 50);  // 24 bits at 1.25us plus the latch, interrupts off
+}
+
+// --- BLE ---
+BLECharacteristic *BLEService::createCharacteristic(const char *uuid, uint32_t props) {
+  if (count >= 16) return nullptr;
+  uuids[count] = uuid;
+  return chars[count++] = new BLECharacteristic(uuid, props);
+}
+
+BLECharacteristic *BLEService::getCharacteristic(const char *uuid) {
+  for (int i = 0; i < count; i++)
+    if (uuids[i] == uuid) return chars[i];
+  return nullptr;
+}
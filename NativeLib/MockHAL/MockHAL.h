@@ -0,0 +1,26 @@
+#pragma once
+// Harness-side access to the native mock HAL.
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Virtual clock. millis()/micros() only move when the firmware delays, blocks
+// on a full UART FIFO or a Stream timeout, or the harness advances them.
+uint64_t mockNowMicros();
+void     mockAdvanceMicros(uint64_t us);
+// Time the firmware spent blocked (delay, delayMicroseconds, UART back-pressure,
+// Stream timeouts, LED output) since the counter was last cleared.
+uint64_t mockBlockedMicros();
+void     mockClearBlocked();
+
+// GPIO seen through digitalRead/digitalWrite (pins 0-69).
+void     mockSetPin(uint8_t pin, bool level);
+bool     mockGetPin(uint8_t pin);
+uint8_t  mockPinMode(uint8_t pin);
+
+// All UARTs that have been constructed, Serial first.
+int              mockSerialCount();
+HardwareSerial  *mockSerialAt(int i);
+
+// Runs every FreeRTOS task that is ready until it blocks (see
+// freertos/FreeRTOS.h). MockMain calls it after each loop().
+void mockRunTasks();
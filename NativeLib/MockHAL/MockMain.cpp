@@ -0,0 +1,181 @@
+// Entry point for native builds of the firmware.
+//
+//   program                       run setup()/loop(); stdin lines go to Serial,
+//                                 Serial output to stdout, other UARTs to stderr
+//   program --bench SCRIPT [--idle N] [--tick US]
+//                                 loop-latency and command benchmark
+//
+// Bench scripts hold one command per line. "@<uart> <text>" sends the text to
+// another UART (e.g. "@3 IC:7400" for the Mega's Nextion port), "wait <ms>"
+// keeps looping for a while, and lines starting with '#' are comments.
+//
+// Unit tests (pio test -e native) bring their own main(), so none of this is
+// built for them.
+#ifndef PIO_UNIT_TESTING
+#include "MockHAL.h"
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+static uint64_t hostNanos() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// One Arduino loop() iteration plus whatever FreeRTOS tasks it woke up.
+static void step() {
+  loop();
+  mockRunTasks();
+}
+
+static unsigned long totalWritten() {
+  unsigned long n = 0;
+  for (int i = 0; i < mockSerialCount(); i++) n += mockSerialAt(i)->bytesWritten();
+  return n;
+}
+
+static void discardOutput() {
+  for (int i = 0; i < mockSerialCount(); i++) mockSerialAt(i)->output().clear();
+}
+
+static int runInteractive() {
+  std::string line;
+  for (;;) {
+    struct pollfd pfd = {0, POLLIN, 0};
+    if (poll(&pfd, 1, 0) > 0) {
+      char buf[256];
+      ssize_t n = read(0, buf, sizeof(buf));
+      if (n <= 0) return 0;
+      Serial.inject(std::string(buf, n));
+    }
+    step();
+    for (int i = 0; i < mockSerialCount(); i++) {
+      HardwareSerial *p = mockSerialAt(i);
+      if (p->output().empty()) continue;
+      if (p == &Serial) fwrite(p->output().data(), 1, p->output().size(), stdout);
+      else fprintf(stderr, "[uart%d] %s\n", p->uart(), p->output().c_str());
+      p->output().clear();
+    }
+    fflush(stdout);
+    usleep(1000);
+    mockAdvanceMicros(1000);
+  }
+}
+
+struct Sample {
+  std::string label;
+  uint64_t hostNs, virtualUs, blockedUs;
+  unsigned long loops, bytes;
+};
+
+static Sample runUntilQuiet(const std::string &label, HardwareSerial *port, unsigned tickUs) {
+  Sample s = {label, 0, 0, 0, 0, 0};
+  unsigned long bytes0 = totalWritten();
+  uint64_t t0 = mockNowMicros();
+  mockClearBlocked();
+  // Until the command is consumed and a full iteration produces no output.
+  for (unsigned quiet = 0; s.loops < 100000 && (port->available() || quiet < 2); s.loops++) {
+    unsigned long before = totalWritten();
+    uint64_t h = hostNanos();
+    step();
+    s.hostNs += hostNanos() - h;
+    mockAdvanceMicros(tickUs);
+    quiet = totalWritten() == before ? quiet + 1 : 0;
+  }
+  s.virtualUs = mockNowMicros() - t0;
+  s.blockedUs = mockBlockedMicros();
+  s.bytes = totalWritten() - bytes0;
+  discardOutput();
+  return s;
+}
+
+static int runBench(const char *script, unsigned long idleLoops, unsigned tickUs) {
+  std::ifstream in(script);
+  if (!in) { fprintf(stderr, "cannot open %s\n", script); return 1; }
+
+  uint64_t t0 = mockNowMicros();
+  setup();
+  printf("setup: %.1f ms virtual, %lu bytes\n", (mockNowMicros() - t0) / 1000.0, totalWritten());
+  discardOutput();
+
+  // Idle loop latency
+  std::vector<uint64_t> ns;
+  ns.reserve(idleLoops);
+  mockClearBlocked();
+  unsigned long idleBytes = totalWritten();
+  uint64_t idleStart = mockNowMicros();
+  for (unsigned long i = 0; i < idleLoops; i++) {
+    uint64_t h = hostNanos();
+    step();
+    ns.push_back(hostNanos() - h);
+    mockAdvanceMicros(tickUs);
+    if (i % 1024 == 0) discardOutput();
+  }
+  double idleSec = (mockNowMicros() - idleStart) / 1e6;
+  idleBytes = totalWritten() - idleBytes;
+  discardOutput();
+  std::sort(ns.begin(), ns.end());
+  uint64_t sum = 0;
+  for (uint64_t v : ns) sum += v;
+  if (!ns.empty())
+    printf("idle loop: %lu iterations, host ns mean %.0f p50 %llu p99 %llu max %llu, "
+           "blocked %.1f us/iter, %.1f bytes/s\n",
+           idleLoops, (double)sum / ns.size(), (unsigned long long)ns[ns.size() / 2],
+           (unsigned long long)ns[ns.size() * 99 / 100], (unsigned long long)ns.back(),
+           mockBlockedMicros() / (double)idleLoops, idleBytes / idleSec);
+
+  // Commands
+  printf("%-28s %8s %10s %10s %7s %7s\n", "command", "loops", "host_us", "virt_us", "blk_us", "bytes");
+  std::string line;
+  uint64_t virtTotal = 0;
+  unsigned commands = 0;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    HardwareSerial *port = &Serial;
+    std::string text = line;
+    if (line.compare(0, 5, "wait ") == 0) {
+      uint64_t until = mockNowMicros() + strtoull(line.c_str() + 5, nullptr, 10) * 1000;
+      mockClearBlocked();
+      unsigned long b = totalWritten(), loops = 0;
+      while (mockNowMicros() < until) { step(); mockAdvanceMicros(tickUs); loops++; discardOutput(); }
+      printf("%-28s %8lu %10s %10s %7llu %7lu\n", line.c_str(), loops, "-", "-",
+             (unsigned long long)mockBlockedMicros(), totalWritten() - b);
+      continue;
+    }
+    if (line[0] == '@') {
+      size_t sp = line.find(' ');
+      port = HardwareSerial::byUart(atoi(line.c_str() + 1));
+      text = sp == std::string::npos ? "" : line.substr(sp + 1);
+      if (!port) { fprintf(stderr, "no uart for %s\n", line.c_str()); continue; }
+    }
+    port->inject(text + "\n");
+    Sample s = runUntilQuiet(line, port, tickUs);
+    virtTotal += s.virtualUs;
+    commands++;
+    printf("%-28s %8lu %10.1f %10llu %7llu %7lu\n", s.label.substr(0, 28).c_str(), s.loops,
+           s.hostNs / 1000.0, (unsigned long long)s.virtualUs, (unsigned long long)s.blockedUs, s.bytes);
+  }
+  if (commands)
+    printf("throughput: %u commands in %.1f ms virtual, %.1f commands/s\n", commands,
+           virtTotal / 1000.0, commands * 1e6 / virtTotal);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *script = nullptr;
+  unsigned long idle = 10000;
+  unsigned tick = 50;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--bench") && i + 1 < argc) script = argv[++i];
+    else if (!strcmp(argv[i], "--idle") && i + 1 < argc) idle = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--tick") && i + 1 < argc) tick = strtoul(argv[++i], nullptr, 10);
+    else { fprintf(stderr, "usage: %s [--bench SCRIPT [--idle N] [--tick US]]\n", argv[0]); return 2; }
+  }
+  if (script) return runBench(script, idle, tick);
+  setup();
+  return runInteractive();
+}
+
+#endif  // PIO_UNIT_TESTING
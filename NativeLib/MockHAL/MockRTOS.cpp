@@ -0,0 +1,121 @@
+#include "MockHAL.h"
+#include <freertos/task.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct MockTask {
+  TaskFunction_t fn;
+  void *arg;
+  std::string name;
+  BaseType_t core;
+  bool turn = false, started = false, dead = false;
+  uint32_t notified = 0;
+  bool waitNotify = false;
+  uint64_t wakeUs = 0;          // UINT64_MAX: no timeout
+  std::condition_variable cv;
+};
+
+static std::mutex lock;
+static std::condition_variable mainCv;
+static std::vector<MockTask *> tasks;
+static thread_local MockTask *self = nullptr;
+
+static bool ready(const MockTask *t) {
+  if (t->dead) return false;
+  if (!t->started) return true;
+  if (t->waitNotify && t->notified) return true;
+  return mockNowMicros() >= t->wakeUs;
+}
+
+// Gives the CPU back to the scheduler and waits for the next turn.
+static void yieldTurn(std::unique_lock<std::mutex> &l) {
+  self->turn = false;
+  mainCv.notify_one();
+  self->cv.wait(l, [] { return self->turn; });
+}
+
+static void taskMain(MockTask *t) {
+  std::unique_lock<std::mutex> l(lock);
+  self = t;
+  t->cv.wait(l, [t] { return t->turn; });
+  l.unlock();
+  t->fn(t->arg);
+  l.lock();
+  t->dead = true;
+  t->turn = false;
+  mainCv.notify_one();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t, void *arg,
+                                   UBaseType_t, TaskHandle_t *handle, BaseType_t core) {
+  MockTask *t = new MockTask();
+  t->fn = fn; t->arg = arg; t->name = name; t->core = core;
+  {
+    std::lock_guard<std::mutex> g(lock);
+    tasks.push_back(t);
+  }
+  std::thread(taskMain, t).detach();
+  if (handle) *handle = t;
+  return pdPASS;
+}
+
+void mockRunTasks() {
+  std::unique_lock<std::mutex> l(lock);
+  // A few passes so a message handed from one task to the next is delivered
+  // within the same loop() iteration, as it would be on two real cores.
+  for (int pass = 0; pass < 4; pass++) {
+    bool ran = false;
+    for (MockTask *t : tasks) {
+      if (!ready(t)) continue;
+      t->started = true;
+      t->waitNotify = false;
+      t->turn = true;
+      t->cv.notify_one();
+      mainCv.wait(l, [t] { return !t->turn; });
+      ran = true;
+    }
+    if (!ran) break;
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (!self) { delay(ticks); return; }
+  std::unique_lock<std::mutex> l(lock);
+  self->wakeUs = mockNowMicros() + (uint64_t)ticks * 1000;
+  yieldTurn(l);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (!task) task = self;
+  if (!task) return;                        // loop() deleting the Arduino loop task
+  std::unique_lock<std::mutex> l(lock);
+  task->dead = true;
+  if (task == self) { yieldTurn(l); }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  if (!self) return 0;
+  std::unique_lock<std::mutex> l(lock);
+  if (!self->notified && ticks) {
+    self->waitNotify = true;
+    self->wakeUs = ticks == portMAX_DELAY ? UINT64_MAX : mockNowMicros() + (uint64_t)ticks * 1000;
+    yieldTurn(l);
+  }
+  uint32_t n = self->notified;
+  if (n) self->notified = clearOnExit ? 0 : n - 1;
+  return n;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (!task) return pdFAIL;
+  std::lock_guard<std::mutex> g(lock);
+  task->notified++;
+  return pdPASS;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(mockNowMicros() / 1000); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return self; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+BaseType_t xPortGetCoreID() { return self ? self->core : 1; }
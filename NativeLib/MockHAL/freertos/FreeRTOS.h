@@ -0,0 +1,22 @@
+#pragma once
+// FreeRTOS stand-in for native builds. Tasks are real threads, but only one
+// runs at a time: mockRunTasks() (called by MockMain after every loop())
+// hands each ready task the CPU until it blocks again, so task code sees
+// the same single-threaded mock HAL and virtual clock as loop() does.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef struct MockTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define pdPASS             1
+#define pdFAIL             0
+#define portMAX_DELAY      0xFFFFFFFFUL
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define tskNO_AFFINITY     0x7FFFFFFF
@@ -0,0 +1,14 @@
+#pragma once
+#include "FreeRTOS.h"
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth,
+                                     void *arg, UBaseType_t priority, TaskHandle_t *handle,
+                                     BaseType_t core);
+void         vTaskDelay(TickType_t ticks);
+void         vTaskDelete(TaskHandle_t task);
+uint32_t     ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+TickType_t   xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t  uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t   xPortGetCoreID();
@@ -0,0 +1,55 @@
+#include "DisplayCache.h"
+
+static uint32_t fnv1a(const char *s, uint8_t len, uint32_t h = 2166136261UL) {
+  for (uint8_t i = 0; i < len; i++) h = (h ^ (uint8_t)s[i]) * 16777619UL;
+  return h;
+}
+
+uint8_t DisplayCache::keyLength(const char *cmd, uint8_t len) {
+  for (uint8_t i = 0; i < len; i++) {
+    if (cmd[i] == '"') break;
+    if (cmd[i] == '=' || cmd[i] == ':') return i + 1;
+  }
+  return len;
+}
+
+DisplayCache::Entry *DisplayCache::find(uint32_t key) {
+  for (uint8_t i = 0; i < DISPLAY_CACHE_ENTRIES; i++)
+    if (entries[i].used && entries[i].key == key) return &entries[i];
+  return nullptr;
+}
+
+void DisplayCache::touch(Entry *e) {
+  for (uint8_t i = 0; i < DISPLAY_CACHE_ENTRIES; i++)
+    if (entries[i].used && entries[i].age < e->age && entries[i].age < 255) entries[i].age++;
+  e->age = 0;
+}
+
+bool DisplayCache::update(const char *cmd, uint8_t len) {
+  uint8_t k = keyLength(cmd, len);
+  uint32_t key = fnv1a(cmd, k);
+  uint32_t value = fnv1a(cmd + k, len - k);
+  Entry *e = find(key);
+  if (e && e->value == value) { suppressed++; return false; }
+  if (!e) {
+    // Free slot, else the least recently written one
+    e = &entries[0];
+    for (uint8_t i = 0; i < DISPLAY_CACHE_ENTRIES && e->used; i++)
+      if (!entries[i].used || entries[i].age > e->age) e = &entries[i];
+    e->used = true;
+    e->key = key;
+    e->age = 255;
+  }
+  e->value = value;
+  touch(e);
+  return true;
+}
+
+void DisplayCache::forget(const char *cmd, uint8_t len) {
+  Entry *e = find(fnv1a(cmd, keyLength(cmd, len)));
+  if (e) e->used = false;
+}
+
+void DisplayCache::clear() {
+  for (uint8_t i = 0; i < DISPLAY_CACHE_ENTRIES; i++) entries[i].used = false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+// What the Nextion is currently showing, one entry per component attribute.
+//
+// A state write such as `t0.txt="7400"` or `PINS:1010...` is split into a key
+// (up to and including the first '=' or ':' outside quotes) and a value.
+// update() returns false when the display already shows that value, so the
+// write can be skipped. Entries hold 32-bit FNV-1a hashes rather than text to
+// keep the table small on the Mega; the least recently written entry is
+// reused when the table is full, which at worst costs one redundant write.
+//
+// Only state goes through the cache. Events ("CLOCK:PULSED") must always be
+// sent, and a write that never reached the display must be forget()-ten so
+// the next one is not suppressed. clear() after anything that may reset the
+// display (page change, baud switch, restart).
+
+#define DISPLAY_CACHE_ENTRIES 12
+
+class DisplayCache {
+ public:
+  // Key length of a command: "obj.attr=" or "PINS:"; the whole text if none.
+  static uint8_t keyLength(const char *cmd, uint8_t len);
+
+  bool update(const char *cmd, uint8_t len);
+  void forget(const char *cmd, uint8_t len);
+  void clear();
+
+  uint16_t suppressed = 0;   // writes skipped because nothing changed
+
+ private:
+  struct Entry {
+    uint32_t key, value;
+    uint8_t  age;            // 0 = most recently written
+    bool     used;
+  };
+  Entry entries[DISPLAY_CACHE_ENTRIES] = {};
+  Entry *find(uint32_t key);
+  void touch(Entry *e);
+};
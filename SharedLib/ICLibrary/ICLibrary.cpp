@@ -0,0 +1,20 @@
+#include <Arduino.h>
+#include "ICLibrary.h"
+
+uint32_t icNameHash(const char *name, uint32_t seed) {
+  uint32_t h = 2166136261UL ^ (seed * 0x9E3779B1UL);
+  for (; *name; name++) {
+    h ^= (uint8_t)*name;
+    h *= 16777619UL;
+  }
+  return h ^ (h >> 16);
+}
+
+int16_t icLookup(const ICNameIndex &ix, const char *name) {
+  if (strlen(name) >= IC_NAME_LEN) return -1;
+  uint8_t bucket = icNameHash(name, 0) % ix.buckets;
+  uint8_t seed = pgm_read_byte(&ix.displace[bucket]);
+  uint8_t key = pgm_read_byte(&ix.slots[icNameHash(name, seed) & ix.slotMask]);
+  if (key == IC_NO_KEY || strcmp_P(name, ix.keys[key].name)) return -1;
+  return pgm_read_byte(&ix.keys[key].index);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+
+// Part-name lookup for the IC tables that icgen.py generates from the front
+// end's JSON library (FrontEnd/digitalkit/public/files/*.json).
+//
+// Every name a part answers to (its part number, the generic 74xx number and
+// any legacy short name) is a key. The keys are placed with a two-level
+// perfect hash: the name's hash picks a bucket, the bucket's displacement
+// seeds a second hash that picks a slot, and the generator chose the
+// displacements so that no two keys share a slot. A lookup is therefore two
+// hashes and one string compare, whatever the size of the library. All
+// arrays live in flash (PROGMEM).
+
+#define IC_NAME_LEN 8        // longest part number plus NUL ("74LS138")
+#define IC_NO_KEY   0xFF     // empty slot
+
+struct ICNameKey {
+  char    name[IC_NAME_LEN];
+  uint8_t index;             // profile index in the generated table
+};
+
+struct ICNameIndex {
+  const ICNameKey *keys;
+  const uint8_t   *displace; // one second-level seed per bucket
+  const uint8_t   *slots;    // key number per slot, IC_NO_KEY if empty
+  uint8_t          buckets;
+  uint8_t          slotMask; // slot count - 1 (a power of two)
+};
+
+// FNV-1a over the name with the seed folded into the basis; icgen.py
+// carries an identical copy.
+uint32_t icNameHash(const char *name, uint32_t seed);
+
+// Profile index for a part name, -1 if the library has no such part.
+int16_t icLookup(const ICNameIndex &ix, const char *name);
@@ -0,0 +1,295 @@
+"""Stuck-at fault simulation and test compaction for the gate parts.
+
+Takes a gate netlist as icgen.py reads it from the part library
+([(type, [inputs], output)], pins numbered however the caller likes) and
+finds a small set of input vectors that between them detect every
+detectable single stuck-at fault:
+
+  * faults are stuck-at-0/1 on every line: each primary input and gate
+    output, plus each branch of a pin that feeds more than one gate;
+  * every input combination is simulated against every fault, 64 patterns
+    per machine word (parallel-pattern simulation), giving for each fault
+    the set of patterns that detect it;
+  * the sets are covered greedily (most new faults first), then vectors
+    whose faults are all caught by later ones are dropped again.
+
+A lower bound on the test length comes from faults no single pattern can
+detect together. When the greedy set is longer than that, a bounded
+branch-and-bound search looks for a shorter cover; a set is reported as
+minimal only once the search has ruled out anything shorter.
+
+icgen.py embeds the sets in the firmware tables (IC_TEST_SETS, see
+ArduinoMegaTest/include/ICDatabase.h). By hand it prints a coverage report
+of the library:
+
+    python3 faultsim.py --library DIR [--vectors]
+
+--vectors adds each part's test set as a TestFarm job line (TestFarm/
+include/Jobs.h), chip pin 1 first.
+"""
+import argparse
+import sys
+
+WORD = 64
+ALL = (1 << WORD) - 1
+
+# Input k toggles every 2**k patterns; within one 64-pattern word that is a
+# fixed mask for k < 6, and all-0 or all-1 for the rest.
+LANE_MASKS = [sum(1 << j for j in range(WORD) if (j >> k) & 1) for k in range(6)]
+
+
+class SimError(Exception):
+    pass
+
+
+def evaluate(kind, words):
+    if kind == "NOT":
+        return ~words[0] & ALL
+    acc = words[0]
+    for w in words[1:]:
+        if kind in ("AND", "NAND"):
+            acc &= w
+        elif kind in ("OR", "NOR"):
+            acc |= w
+        else:
+            acc ^= w
+    return ~acc & ALL if kind in ("NAND", "NOR", "XNOR") else acc
+
+
+class Circuit:
+    """A gate netlist with its primary inputs and observed outputs."""
+
+    def __init__(self, netlist):
+        self.netlist = netlist
+        driven = {o for _, _, o in netlist}
+        self.inputs = sorted({p for _, ins, _ in netlist for p in ins} - driven)
+        self.outputs = sorted(driven)
+        if len(self.inputs) > 16:
+            raise SimError("%d inputs are too many to simulate exhaustively" % len(self.inputs))
+        fanout = {}
+        for g, (_, ins, _) in enumerate(netlist):
+            for p in ins:
+                fanout.setdefault(p, []).append(g)
+        # (pin, gate or None for the pin itself, stuck value)
+        self.faults = []
+        for p in sorted(set(self.inputs) | driven):
+            self.faults += [(p, None, 0), (p, None, 1)]
+            if len(fanout.get(p, [])) > 1:
+                self.faults += [(p, g, v) for g in fanout[p] for v in (0, 1)]
+
+    def patterns(self):
+        return 1 << len(self.inputs)
+
+    def input_words(self, base):
+        words = {}
+        for k, p in enumerate(self.inputs):
+            if k < 6:
+                words[p] = LANE_MASKS[k]
+            else:
+                words[p] = ALL if (base >> k) & 1 else 0
+        return words
+
+    def simulate(self, words, fault=None):
+        """Output words for one block of patterns, with at most one fault."""
+        values = dict(words)
+
+        def stuck(pin, gate):
+            if fault and fault[0] == pin and fault[1] in (None, gate):
+                return ALL if fault[2] else 0
+            return values[pin]
+
+        for p in self.inputs:
+            values[p] = stuck(p, -1)
+        for g, (kind, ins, out) in enumerate(self.netlist):
+            try:
+                values[out] = evaluate(kind, [stuck(p, g) for p in ins])
+            except KeyError as e:
+                raise SimError("pin %s is read before its gate drives it" % e)
+            values[out] = stuck(out, -1)
+        return [values[p] for p in self.outputs]
+
+    def detection(self):
+        """For each fault, the set of patterns that detect it (as an int)."""
+        total = self.patterns()
+        valid = ALL if total >= WORD else (1 << total) - 1
+        detects = [0] * len(self.faults)
+        for base in range(0, total, WORD):
+            words = self.input_words(base)
+            good = self.simulate(words)
+            for f, fault in enumerate(self.faults):
+                diff = 0
+                for a, b in zip(good, self.simulate(words, fault)):
+                    diff |= a ^ b
+                detects[f] |= (diff & valid) << base
+        return detects
+
+    def pin_word(self, pattern):
+        """The pins (bit p-1 for pin p) a pattern drives high."""
+        return sum(1 << (p - 1) for k, p in enumerate(self.inputs) if (pattern >> k) & 1)
+
+    def response(self, pattern):
+        """The pins whose outputs go high under a pattern."""
+        base = pattern & ~(WORD - 1)
+        outs = self.simulate(self.input_words(base))
+        lane = pattern - base
+        return sum(1 << (p - 1) for p, w in zip(self.outputs, outs) if (w >> lane) & 1)
+
+
+def bits(n):
+    k = 0
+    while n:
+        if n & 1:
+            yield k
+        n >>= 1
+        k += 1
+
+
+def compact(detects):
+    """Greedy cover of the detectable faults, then reverse-order pruning."""
+    open_faults = {f for f, d in enumerate(detects) if d}
+    by_pattern = {}
+    for f in open_faults:
+        for p in bits(detects[f]):
+            by_pattern.setdefault(p, set()).add(f)
+    chosen = []
+    while open_faults:
+        best = max(sorted(by_pattern), key=lambda p: len(by_pattern[p] & open_faults))
+        chosen.append(best)
+        open_faults -= by_pattern[best]
+    for p in reversed(list(chosen)):
+        rest = [q for q in chosen if q != p]
+        covered = set().union(*(by_pattern[q] for q in rest)) if rest else set()
+        if by_pattern[p] <= covered:
+            chosen = rest
+    return chosen
+
+
+def search(covers, first, open_faults, size, budget):
+    """A cover of open_faults with at most size patterns, None if there is
+    none, or False once budget[0] nodes have been spent."""
+    if not open_faults:
+        return []
+    if size == 0:
+        return None
+    budget[0] -= 1
+    if budget[0] < 0:
+        return False
+    # Branch on the open fault with the fewest detecting patterns.
+    f = min(bits(open_faults), key=lambda f: len(first[f]))
+    for p in first[f]:
+        rest = search(covers, first, open_faults & ~covers[p], size - 1, budget)
+        if rest is False:
+            return False
+        if rest is not None:
+            return [p] + rest
+    return None
+
+
+def minimize(detects, chosen, bound, budget=200000):
+    """(patterns, minimal): chosen, or a shorter cover if the search finds one."""
+    covers, first = {}, []
+    open_faults = 0
+    for f, d in enumerate(detects):
+        first.append(list(bits(d)))
+        if d:
+            open_faults |= 1 << f
+        for p in first[f]:
+            covers[p] = covers.get(p, 0) | 1 << f
+    left = [budget]
+    for size in range(bound, len(chosen)):
+        found = search(covers, first, open_faults, size, left)
+        if found is False:
+            return chosen, False
+        if found is not None:
+            return sorted(found), True
+    return chosen, True
+
+
+def lower_bound(detects):
+    """Faults that pairwise share no detecting pattern each need a vector."""
+    taken, bound = 0, 0
+    for d in sorted((d for d in detects if d), key=lambda d: bin(d).count("1")):
+        if not d & taken:
+            taken |= d
+            bound += 1
+    return bound
+
+
+class TestSet:
+    def __init__(self, netlist):
+        circuit = Circuit(netlist)
+        detects = circuit.detection()
+        self.circuit = circuit
+        self.faults = len(detects)
+        self.detected = sum(1 for d in detects if d)
+        self.redundant = [circuit.faults[f] for f, d in enumerate(detects) if not d]
+        self.exhaustive = circuit.patterns()
+        self.bound = lower_bound(detects)
+        self.patterns, self.minimal = minimize(detects, compact(detects), self.bound)
+
+    def words(self):
+        return [self.circuit.pin_word(p) for p in self.patterns]
+
+    def vectors(self, pin_count):
+        """The set as job vectors over pins 1..pin_count."""
+        out = []
+        for p in self.patterns:
+            drive, resp = self.circuit.pin_word(p), self.circuit.response(p)
+            row = ""
+            for pin in range(1, pin_count + 1):
+                if pin in self.circuit.inputs:
+                    row += "1" if drive >> (pin - 1) & 1 else "0"
+                elif pin in self.circuit.outputs:
+                    row += "H" if resp >> (pin - 1) & 1 else "L"
+                else:
+                    row += "X"
+            out.append(row)
+        return out
+
+
+def fault_name(fault):
+    pin, gate, value = fault
+    return "pin %d%s stuck-at-%d" % (pin, "" if gate is None else " (gate %d)" % (gate + 1), value)
+
+
+def main(argv):
+    import icgen
+
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--library", required=True, help="directory with the *.json part files")
+    ap.add_argument("--vectors", action="store_true", help="print each test set as a TestFarm job line")
+    args = ap.parse_args(argv)
+    try:
+        parts = icgen.load_parts(args.library)
+    except icgen.GenError as e:
+        print("faultsim: %s" % e, file=sys.stderr)
+        return 1
+
+    print("%-8s %6s %9s %10s %7s %5s  %s" % ("part", "faults", "detected", "exhaustive", "compact", "bound", ""))
+    jobs = []
+    for part in parts:
+        name = part["partNumber"].strip().upper()
+        pins = icgen.chip_pins(part)
+        try:
+            netlist = icgen.gates(part, {p: p for p in pins})
+            if not netlist:
+                print("%-8s %6s %9s %10s %7s %5s  no gate netlist" % (name, "-", "-", "-", "-", "-"))
+                continue
+            ts = TestSet(netlist)
+        except (icgen.GenError, SimError) as e:
+            print("faultsim: %s: %s" % (name, e), file=sys.stderr)
+            return 1
+        note = "minimal" if ts.minimal else "not proven minimal"
+        print("%-8s %6d %9s %10d %7d %5d  %s" % (name, ts.faults, "%d/%d" % (ts.detected, ts.faults),
+                                                  ts.exhaustive, len(ts.patterns), ts.bound, note))
+        for fault in ts.redundant:
+            print("         undetectable: %s" % fault_name(fault))
+        jobs.append("%s  %s" % (name, " ".join(ts.vectors(len(pins)))))
+    if args.vectors:
+        print("")
+        print("\n".join(jobs))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,391 @@
+"""Generates the firmware IC tables from the front end's JSON part library.
+
+The JSON files under FrontEnd/digitalkit/public/files describe every part the
+web app knows about; this script turns them into a flash-resident profile
+table plus a perfect-hash name index (see ICLibrary.h) so the testers and
+the front end agree on one list of parts.
+
+As a PlatformIO pre-build script it reads two project options:
+
+    extra_scripts = pre:../SharedLib/ICLibrary/icgen.py
+    custom_ic_format = mega16                       ; or esp14
+    custom_ic_library = ../FrontEnd/digitalkit/public/files
+
+and writes src/ICTable.gen.cpp (only when its contents change). The mega16
+tables also carry each gate part's compacted structural test set, worked
+out by faultsim.py. Run it by hand with
+
+    python3 icgen.py --format mega16 --library DIR --out FILE
+"""
+import argparse
+import glob
+import inspect
+import json
+import os
+import re
+import sys
+
+# SCons runs pre-build scripts without __file__; the code object still knows.
+sys.path.insert(0, os.path.dirname(os.path.abspath(inspect.getframeinfo(inspect.currentframe()).filename)))
+import faultsim  # noqa: E402
+
+# Behavioral models of ArduinoMegaTest (BehaviorModel.h), by generic number.
+MODELS = {
+    "74194": "MODEL_SHIFT_194",
+    "7485": "MODEL_CMP_7485",
+    "7473": "MODEL_JK_7473",
+    "74139": "MODEL_DEC_74139",
+    "74157": "MODEL_MUX_74157",
+}
+
+# Names the firmware answered to before the table was generated.
+LEGACY_NAMES = {
+    "74HC194": ["194"],
+}
+
+GATE_TYPES = {"AND", "OR", "NAND", "NOR", "XOR", "XNOR", "NOT"}
+CLOCK_NAME = re.compile(r"^([A-Z]?CLK[A-Z0-9]*|CP)$")
+GATE_INPUT = re.compile(r"^(\d)([A-D])$")
+GATE_OUTPUT = re.compile(r"^(\d)Y$")
+PART_NUMBER = re.compile(r"^(74|54)[A-Z]*(\d+)$")
+
+NAME_LEN = 8        # IC_NAME_LEN, including the NUL
+NO_KEY = 0xFF       # IC_NO_KEY
+
+
+class GenError(Exception):
+    pass
+
+
+def name_hash(name, seed):
+    """Same as icNameHash() in ICLibrary.cpp."""
+    h = 2166136261 ^ ((seed * 0x9E3779B1) & 0xFFFFFFFF)
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+    return h ^ (h >> 16)
+
+
+# --- Reading the library ---
+
+def walk(node):
+    if isinstance(node, dict):
+        if "partNumber" in node and "pinConfiguration" in node:
+            yield node
+            return
+        for value in node.values():
+            yield from walk(value)
+    elif isinstance(node, list):
+        for value in node:
+            yield from walk(value)
+
+
+def load_parts(library):
+    files = sorted(glob.glob(os.path.join(library, "*.json")))
+    if not files:
+        raise GenError("no JSON files in %s" % library)
+    parts, seen = [], set()
+    for path in files:
+        with open(path, encoding="utf-8") as f:
+            for part in walk(json.load(f)):
+                number = part["partNumber"].strip().upper()
+                if number in seen:
+                    raise GenError("%s: %s is listed twice" % (path, number))
+                seen.add(number)
+                parts.append(part)
+    return parts
+
+
+def role(pin):
+    kind = pin["type"].strip().upper()
+    name = pin["name"].strip().upper()
+    if kind == "POWER":
+        return "G" if "GND" in name or name == "VSS" else "V"
+    if kind == "NC" or name == "NC":
+        return "N"
+    if kind in ("OUTPUT", "IO"):    # bidirectional pins are sampled, never driven
+        return "O"
+    if CLOCK_NAME.match(name):
+        return "C"
+    return "I"
+
+
+def chip_pins(part):
+    """{chip pin: (role, name)} in pin order."""
+    pins = {}
+    for pin in part["pinConfiguration"]:
+        pins[int(pin["pin"])] = (role(pin), pin["name"].strip())
+    count = int(part.get("pinCount") or len(pins))
+    if sorted(pins) != list(range(1, count + 1)):
+        raise GenError("%s: pins do not run 1..%d" % (part["partNumber"], count))
+    return pins
+
+
+def generic_number(number):
+    m = PART_NUMBER.match(number)
+    return m.group(1) + m.group(2) if m else number
+
+
+def part_names(part):
+    number = part["partNumber"].strip().upper()
+    names = [number, generic_number(number)] + LEGACY_NAMES.get(number, [])
+    unique = []
+    for name in names:
+        if name not in unique:
+            unique.append(name)
+    return unique
+
+
+def gates(part, socket):
+    """Gate netlist of a LOGIC_GATE part: [(type, [inputs], output)] in socket pins."""
+    kind = (part.get("logicType") or "").upper()
+    if part.get("category") != "LOGIC_GATE" or kind not in GATE_TYPES:
+        return []
+    units = {}
+    for pin in part["pinConfiguration"]:
+        name = pin["name"].strip().upper()
+        m = GATE_INPUT.match(name)
+        if m:
+            units.setdefault(m.group(1), [[], None])[0].append((m.group(2), socket[int(pin["pin"])]))
+            continue
+        m = GATE_OUTPUT.match(name)
+        if m:
+            units.setdefault(m.group(1), [[], None])[1] = socket[int(pin["pin"])]
+    netlist = []
+    for unit in sorted(units):
+        inputs, output = units[unit]
+        if not inputs or output is None or len(inputs) > 4:
+            raise GenError("%s: cannot read gate %s from the pin names" % (part["partNumber"], unit))
+        netlist.append((kind, [p for _, p in sorted(inputs)], output))
+    return netlist
+
+
+# --- Name index ---
+
+def build_index(keys):
+    """Two-level perfect hash over the key names: (buckets, displace, slots)."""
+    if len(keys) >= NO_KEY:
+        raise GenError("%d names do not fit an 8-bit key number" % len(keys))
+    buckets = max(1, (len(keys) + 1) // 2)
+    size = 1
+    while size < len(keys) * 5 // 4:
+        size *= 2
+    while size <= 256:
+        groups = {}
+        for k, name in enumerate(keys):
+            groups.setdefault(name_hash(name, 0) % buckets, []).append(k)
+        slots = [NO_KEY] * size
+        displace = [0] * buckets
+        for b in sorted(groups, key=lambda b: -len(groups[b])):
+            for seed in range(1, 256):
+                taken = [name_hash(keys[k], seed) & (size - 1) for k in groups[b]]
+                if len(set(taken)) == len(taken) and all(slots[s] == NO_KEY for s in taken):
+                    for k, s in zip(groups[b], taken):
+                        slots[s] = k
+                    displace[b] = seed
+                    break
+            else:
+                break
+        else:
+            return buckets, displace, slots
+        size *= 2
+    raise GenError("no perfect hash for %d names" % len(keys))
+
+
+def name_keys(profiles):
+    """[(name, profile index)]; a part number always wins over another part's alias."""
+    owner = {}
+    for i, (part, _) in enumerate(profiles):
+        for rank, name in enumerate(part_names(part)):
+            if len(name) >= NAME_LEN:
+                raise GenError("%s: name %s is longer than %d characters" % (part["partNumber"], name, NAME_LEN - 1))
+            if name in owner and owner[name][1] <= rank:
+                continue
+            owner[name] = (i, rank)
+    return sorted(((name, i) for name, (i, _) in owner.items()), key=lambda k: (k[1], k[0]))
+
+
+def emit_index(out, keys):
+    buckets, displace, slots = build_index([name for name, _ in keys])
+    out.append("static const ICNameKey IC_KEYS[] PROGMEM = {")
+    for n in range(0, len(keys), 6):
+        out.append("  " + " ".join('{"%s",%d},' % k for k in keys[n:n + 6]))
+    out.append("};")
+    out.append("static const uint8_t IC_DISPLACE[] PROGMEM = {%s};" % ",".join(map(str, displace)))
+    out.append("static const uint8_t IC_SLOTS[] PROGMEM = {")
+    for n in range(0, len(slots), 16):
+        out.append("  " + ",".join("0x%02X" % s for s in slots[n:n + 16]) + ",")
+    out.append("};")
+    out.append("static const ICNameIndex IC_INDEX = {IC_KEYS, IC_DISPLACE, IC_SLOTS, %d, %d};"
+               % (buckets, len(slots) - 1))
+
+
+# --- ArduinoMegaTest: 16-pin socket, ICProfile masks (ICDatabase.h) ---
+
+def mega_socket(part, pins):
+    """chip pin -> socket pin. A DIP sits in the 16-pin socket from pin 1, so
+    the far row of a smaller package moves up: on a 14-pin part chip pins
+    8-14 land on socket pins 10-16 and socket pins 8/9 stay open, wherever
+    its supply pins are."""
+    count = len(pins)
+    if count > 16:
+        return None
+    half = count // 2
+    return {p: p if p <= half else p + 16 - count for p in pins}
+
+
+def mega16(parts):
+    profiles = []
+    for part in parts:
+        pins = chip_pins(part)
+        socket = mega_socket(part, pins)
+        if socket is None:
+            print("icgen: %s has %d pins, skipped" % (part["partNumber"], len(pins)), file=sys.stderr)
+            continue
+        if len(pins) == 14 and {8, 9} & set(socket.values()):
+            raise GenError("%s: a 14-pin part cannot use socket pins 8/9" % part["partNumber"])
+        profiles.append((part, (pins, socket)))
+    # Identify tracks candidates in a 32-bit set, so gate parts go first.
+    profiles.sort(key=lambda p: not gates(p[0], p[1][1]))
+    if len(profiles) > 127:
+        raise GenError("%d profiles do not fit an int8_t index" % len(profiles))
+
+    out = ["const ICProfile IC_DB[] PROGMEM = {"]
+    for n, (part, (pins, socket)) in enumerate(profiles):
+        layout, names = ["N"] * 16, ["NC"] * 16
+        for p, (r, name) in pins.items():
+            layout[socket[p] - 1], names[socket[p] - 1] = r, name
+        netlist = gates(part, socket)
+        model = MODELS.get(generic_number(part["partNumber"].strip().upper()), "MODEL_NONE")
+        out.append("  // %s: %s" % (part["partNumber"], part.get("description", "")))
+        out.append("  // " + " ".join(names))
+        head = '  IC_PROFILE("%s", "%s",' % (part["partNumber"].strip().upper(), "".join(layout))
+        body = ",".join("{%s,{%s},%d,%d}" % (t, ",".join(map(str, i)), len(i), o) for t, i, o in netlist)
+        tail = "},%d%s)%s" % (len(netlist), ", " + model if model != "MODEL_NONE" else "",
+                             "," if n + 1 < len(profiles) else "")
+        out.append("%s {%s%s" % (head, body, tail))
+    out.append("};")
+    out.append("const uint8_t IC_DB_COUNT = sizeof(IC_DB)/sizeof(IC_DB[0]);")
+    out.append("")
+    emit_test_sets(out, profiles)
+    out.append("")
+    emit_index(out, name_keys(profiles))
+    out.append("")
+    out.append("int8_t findProfile(const char *name) {")
+    out.append("  return icLookup(IC_INDEX, name);")
+    out.append("}")
+    return ['#include <Arduino.h>', '#include <ICLibrary.h>', '#include "ICDatabase.h"', ""] + out
+
+
+def emit_test_sets(out, profiles):
+    """IC_TEST_WORDS and IC_TEST_SETS (one per profile) from faultsim.py."""
+    words, sets = [], []
+    out.append("// Input words of the structural test sets (faultsim.py): each gate part's")
+    out.append("// fewest vectors that detect every detectable single stuck-at fault.")
+    out.append("const uint16_t IC_TEST_WORDS[] PROGMEM = {")
+    for part, (_, socket) in profiles:
+        netlist = gates(part, socket)
+        if not netlist:
+            sets.append((0, 0))
+            continue
+        try:
+            ts = faultsim.TestSet(netlist)
+        except faultsim.SimError as e:
+            raise GenError("%s: %s" % (part["partNumber"], e))
+        if len(ts.patterns) > 255:
+            raise GenError("%s: %d test vectors do not fit a uint8_t" % (part["partNumber"], len(ts.patterns)))
+        sets.append((len(words), len(ts.patterns)))
+        words += ts.words()
+        out.append("  // %s: %d of %d vectors, %d/%d faults%s" % (
+            part["partNumber"].strip().upper(), len(ts.patterns), ts.exhaustive,
+            ts.detected, ts.faults, "" if ts.minimal else " (not proven minimal)"))
+        out.append("  " + " ".join("0x%04X," % w for w in ts.words()))
+    if not words:
+        out.append("  0")
+    out.append("};")
+    out.append("const ICTestSet IC_TEST_SETS[] PROGMEM = {")
+    for n in range(0, len(sets), 8):
+        out.append("  " + " ".join("{%d,%d}," % s for s in sets[n:n + 8]))
+    out.append("};")
+
+
+# --- Esp_test_1_Jun3: 14-pin socket, pin-for-pin (include/ICDatabase.h) ---
+
+ESP_TYPES = {"V": "VCC", "G": "GND", "I": "INPUT", "C": "INPUT", "O": "OUTPUT", "N": "NC"}
+
+
+def esp14(parts):
+    profiles = [(p, chip_pins(p)) for p in parts if len(chip_pins(p)) == 14]
+    out = ["const ICProfile IC_DB[] = {"]
+    for n, (part, pins) in enumerate(profiles):
+        out.append("    {// %s %s" % (part["partNumber"], part.get("description", "")))
+        out.append('     "%s",' % part["partNumber"].strip().upper())
+        cells = ['{%d, "%s", false}' % (p, ESP_TYPES[pins[p][0]]) for p in range(1, 15)]
+        out.append("     {%s}}%s" % (", ".join(cells), "," if n + 1 < len(profiles) else ""))
+    out.append("};")
+    out.append("const uint8_t IC_DB_COUNT = sizeof(IC_DB) / sizeof(IC_DB[0]);")
+    out.append("")
+    emit_index(out, name_keys(profiles))
+    out.append("")
+    out.append("const ICProfile *findIC(const char *name)")
+    out.append("{")
+    out.append("  int16_t i = icLookup(IC_INDEX, name);")
+    out.append("  return i < 0 ? nullptr : &IC_DB[i];")
+    out.append("}")
+    return ['#include <Arduino.h>', '#include <ICLibrary.h>', '#include "ICDatabase.h"', ""] + out
+
+
+FORMATS = {"mega16": mega16, "esp14": esp14}
+
+
+def generate(fmt, library, out_path):
+    if fmt not in FORMATS:
+        raise GenError("unknown format %s (%s)" % (fmt, ", ".join(sorted(FORMATS))))
+    parts = load_parts(library)
+    header = [
+        "// Generated by SharedLib/ICLibrary/icgen.py (%s) from %d parts in" % (fmt, len(parts)),
+        "// FrontEnd/digitalkit/public/files/*.json. Do not edit; change the JSON",
+        "// and rebuild.",
+    ]
+    text = "\n".join(header + FORMATS[fmt](parts)) + "\n"
+    try:
+        with open(out_path, encoding="utf-8") as f:
+            if f.read() == text:
+                return False
+    except OSError:
+        pass
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(text)
+    return True
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--format", required=True, choices=sorted(FORMATS))
+    ap.add_argument("--library", required=True, help="directory with the *.json part files")
+    ap.add_argument("--out", required=True)
+    args = ap.parse_args(argv)
+    try:
+        generate(args.format, args.library, args.out)
+    except GenError as e:
+        print("icgen: %s" % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO/SCons builtin)
+except NameError:
+    env = None
+
+if env is not None:
+    project = env.subst("$PROJECT_DIR")
+    library = os.path.join(project, env.GetProjectOption("custom_ic_library"))
+    target = os.path.join(env.subst("$PROJECT_SRC_DIR"), "ICTable.gen.cpp")
+    try:
+        if generate(env.GetProjectOption("custom_ic_format"), library, target):
+            print("icgen: wrote %s" % os.path.relpath(target, project))
+    except GenError as e:
+        sys.stderr.write("icgen: %s\n" % e)
+        env.Exit(1)
+elif __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
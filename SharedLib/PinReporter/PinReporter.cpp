@@ -0,0 +1,14 @@
+#include "PinReporter.h"
+
+ReportKind PinReporter::poll(uint16_t word, uint32_t nowMs) {
+  uint32_t since = nowMs - lastMs;
+  ReportKind kind = REPORT_NONE;
+  if (forced || (heartbeatMs && since >= heartbeatMs)) kind = REPORT_FULL;
+  else if (word != last && since >= minIntervalMs) kind = REPORT_DELTA;
+  if (kind == REPORT_NONE) return kind;
+  delta = word ^ last;
+  last = word;
+  lastMs = nowMs;
+  forced = false;
+  return kind;
+}
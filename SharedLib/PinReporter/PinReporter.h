@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+
+// Change-driven pin reporting.
+//
+// poll() is called every loop pass with the current pin word and the time in
+// ms. It diffs the word against the last one reported and asks for
+//   REPORT_DELTA  some bits changed and at least minIntervalMs have passed
+//                 since the previous report (changes inside the window are
+//                 merged into the next delta);
+//   REPORT_FULL   nothing was reported for heartbeatMs, or force() was called
+//                 (IC change, host reconnect) - send the whole word.
+// An idle, unchanged socket costs one heartbeat per heartbeatMs on the wire.
+
+enum ReportKind : uint8_t { REPORT_NONE, REPORT_DELTA, REPORT_FULL };
+
+class PinReporter {
+ public:
+  uint16_t minIntervalMs = 5;
+  uint16_t heartbeatMs   = 1000;   // 0 = no heartbeat
+
+  ReportKind poll(uint16_t word, uint32_t nowMs);
+  void force() { forced = true; }
+
+  uint16_t value()   const { return last; }     // word as of the last report
+  uint16_t changed() const { return delta; }    // bits that differ in a DELTA
+  uint32_t stamp()   const { return lastMs; }   // time of the last report
+
+ private:
+  uint16_t last = 0, delta = 0;
+  uint32_t lastMs = 0;
+  bool forced = true;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer ring of N (a power of two)
+// entries. One task may push() and one other task may pop() concurrently;
+// head and tail are only ever written by their own side and published with
+// release/acquire ordering, so the two can sit on different ESP32 cores.
+// push() never blocks: when the ring is full it fails and the caller decides
+// what to drop.
+
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+ public:
+  bool push(const T &v) {
+    uint16_t h = head, t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    if ((uint16_t)(h - t) == N) return false;
+    buf[h & (N - 1)] = v;
+    __atomic_store_n(&head, (uint16_t)(h + 1), __ATOMIC_RELEASE);
+    if ((uint16_t)(h + 1 - t) > peak) peak = h + 1 - t;
+    return true;
+  }
+
+  bool pop(T &v) {
+    uint16_t t = tail, h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    if (h == t) return false;
+    v = buf[t & (N - 1)];
+    __atomic_store_n(&tail, (uint16_t)(t + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  uint16_t size() const {
+    return (uint16_t)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE));
+  }
+  uint16_t capacity() const { return N; }
+  uint16_t highWater() const { return peak; }   // deepest the ring has been
+
+ private:
+  T buf[N];
+  uint16_t head = 0, tail = 0;
+  uint16_t peak = 0;
+};
@@ -0,0 +1,32 @@
+#include "Telemetry.h"
+#include <stdio.h>
+
+uint32_t LoopHistogram::bucketLimit(uint8_t bucket) {
+  return bucket < LOOP_BUCKETS - 1 ? 64UL << (2 * bucket) : 0;
+}
+
+void LoopHistogram::record(uint32_t us) {
+  uint8_t b = 0;
+  while (b < LOOP_BUCKETS - 1 && us >= bucketLimit(b)) b++;
+  counts[b]++;
+  if (us > worst) worst = us;
+}
+
+void LoopHistogram::clear() {
+  for (uint8_t i = 0; i < LOOP_BUCKETS; i++) counts[i] = 0;
+  worst = 0;
+}
+
+int LoopHistogram::format(char *buf, size_t n) const {
+  int len = 0;
+  for (uint8_t i = 0; i < LOOP_BUCKETS && len < (int)n; i++)
+    len += snprintf(buf + len, n - len, i ? ",%lu" : "%lu", (unsigned long)counts[i]);
+  if (len < (int)n) len += snprintf(buf + len, n - len, ":MAX=%lu", (unsigned long)worst);
+  return len < (int)n ? len : (int)n - 1;
+}
+
+int LinkCounters::format(char *buf, size_t n) const {
+  int len = snprintf(buf, n, "RX=%lu/%lu:TX=%lu/%lu", (unsigned long)rxBytes, (unsigned long)rxMsgs,
+                     (unsigned long)txBytes, (unsigned long)txMsgs);
+  return len < (int)n ? len : (int)n - 1;
+}
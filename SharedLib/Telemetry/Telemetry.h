@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Runtime counters behind the STATS command.
+//
+// LoopHistogram sorts loop iteration times into buckets whose upper bounds
+// grow by 4x from 64 us (64, 256, 1024, 4096, 16384 us, then everything
+// longer) and keeps the worst case, so a stalled link shows up as counts in
+// the top buckets rather than as a slightly higher average.
+// LinkCounters tallies bytes and messages in each direction of one transport.
+// Both format themselves with format() into a caller's buffer and return the
+// length, so the same text can go to a UART or a BLE notification.
+
+#define LOOP_BUCKETS 6
+
+class LoopHistogram {
+ public:
+  void record(uint32_t us);
+  void clear();
+  uint32_t count(uint8_t bucket) const { return bucket < LOOP_BUCKETS ? counts[bucket] : 0; }
+  uint32_t maxUs() const { return worst; }
+  static uint32_t bucketLimit(uint8_t bucket);   // upper bound in us, 0 = none
+
+  // "<n0>,<n1>,...,<n5>:MAX=<us>"
+  int format(char *buf, size_t n) const;
+
+ private:
+  uint32_t counts[LOOP_BUCKETS] = {0};
+  uint32_t worst = 0;
+};
+
+struct LinkCounters {
+  uint32_t rxBytes = 0, rxMsgs = 0;
+  uint32_t txBytes = 0, txMsgs = 0;
+
+  void rx(uint32_t bytes) { rxBytes += bytes; rxMsgs++; }
+  void tx(uint32_t bytes) { txBytes += bytes; txMsgs++; }
+  void clear() { rxBytes = rxMsgs = txBytes = txMsgs = 0; }
+
+  // "RX=<bytes>/<msgs>:TX=<bytes>/<msgs>"
+  int format(char *buf, size_t n) const;
+};
@@ -0,0 +1,68 @@
+#include "TesterFrame.h"
+
+uint8_t frameCrc8(const uint8_t *p, uint8_t n, uint8_t crc) {
+  while (n--) {
+    crc ^= *p++;
+    for (uint8_t k = 0; k < 8; k++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+
+uint8_t frameEncode(uint8_t op, const uint8_t *payload, uint8_t len, uint8_t *out) {
+  if (len > FRAME_MAX_PAYLOAD) len = FRAME_MAX_PAYLOAD;
+  out[0] = FRAME_SOF;
+  out[1] = op;
+  out[2] = len;
+  for (uint8_t i = 0; i < len; i++) out[3 + i] = payload[i];
+  out[3 + len] = frameCrc8(out + 1, len + 2);
+  return len + FRAME_OVERHEAD;
+}
+
+bool FrameParser::feed(uint8_t b) {
+  switch (state) {
+    case 0:  // hunting for start-of-frame
+      if (b == FRAME_SOF) state = 1;
+      return false;
+    case 1:
+      frame.op = b;
+      crc = frameCrc8(&b, 1);
+      state = 2;
+      return false;
+    case 2:
+      if (b > FRAME_MAX_PAYLOAD) { state = 0; return false; }
+      frame.len = b;
+      crc = frameCrc8(&b, 1, crc);
+      pos = 0;
+      state = b ? 3 : 4;
+      return false;
+    case 3:
+      frame.data[pos++] = b;
+      crc = frameCrc8(&b, 1, crc);
+      if (pos == frame.len) state = 4;
+      return false;
+    default:
+      state = 0;
+      if (b == crc) return true;
+      crcErrors++;
+      return false;
+  }
+}
+
+uint8_t packPinString(const char *bits, uint8_t n, uint8_t *payload) {
+  if (n > 16) n = 16;
+  uint16_t w = 0;
+  for (uint8_t j = 0; j < n; j++)
+    if (bits[j] == '1') w |= 1u << j;
+  payload[0] = n;
+  payload[1] = w & 0xFF;
+  payload[2] = w >> 8;
+  return 3;
+}
+
+uint8_t unpackPinString(const uint8_t *payload, char *bits) {
+  uint8_t n = payload[0] > 16 ? 16 : payload[0];
+  uint16_t w = payload[1] | (uint16_t)payload[2] << 8;
+  for (uint8_t j = 0; j < n; j++) bits[j] = (w >> j & 1) ? '1' : '0';
+  bits[n] = 0;
+  return n;
+}
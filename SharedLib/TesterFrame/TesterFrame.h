@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+// Binary framing for the tester serial links.
+//
+//   0xA5 | op | len | payload[len] | crc8
+//
+// crc8 (poly 0x07, init 0) covers op, len and payload. A link enters binary
+// mode with the ASCII command "BIN:ON" (answered by "OK:BIN") and leaves it
+// with an OP_EXIT frame. Whatever a tester answers to a frame comes back
+// framed before that frame's OP_ACK/OP_NAK: replies to OP_CMD, and the text
+// lines any request prints, arrive as OP_CMD frames holding one line each
+// (no terminator). A line longer than FRAME_MAX_PAYLOAD continues over full
+// frames and ends with a shorter, possibly empty, one. Unsolicited log lines
+// may still appear as plain ASCII; since 0xA5 never occurs in ASCII text,
+// receivers just skip bytes until the next start-of-frame.
+
+#define FRAME_SOF         0xA5
+#define FRAME_MAX_PAYLOAD 32
+#define FRAME_OVERHEAD    4
+
+enum FrameOp : uint8_t {
+  OP_SYNC    = 0x01,  // -> ACK
+  OP_IC      = 0x02,  // IC name (ASCII, no terminator)
+  OP_PINS    = 0x03,  // count, word lo, word hi: packed pin string, bit j = char j
+  OP_CLOCK   = 0x04,  // single clock pulse
+  OP_STATUS  = 0x05,  // request; reply carries pin count, gate count, IC name
+  OP_CMD     = 0x06,  // ASCII command tunnelled through the frame layer, or a reply line
+  OP_DELTA   = 0x07,  // ms (u32 LE), changed lo/hi, value lo/hi: pin string bits, as OP_PINS
+  OP_CAPTURE = 0x08,  // runs of (value lo/hi, count lo/hi), value packed as OP_PINS
+  OP_VEC     = 0x09,  // up: (in, expect, don't care lo/hi, clocks) tuples; down: n, passed, bitmap
+  OP_ACK     = 0x10,  // op acknowledged
+  OP_NAK     = 0x11,  // op, error code
+  OP_EXIT    = 0x1F   // back to ASCII lines
+};
+
+enum FrameError : uint8_t {
+  FERR_UNKNOWN_OP = 1,
+  FERR_LENGTH     = 2,
+  FERR_NO_IC      = 3,
+  FERR_NOT_FOUND  = 4,
+  FERR_FULL       = 5
+};
+
+struct Frame {
+  uint8_t op;
+  uint8_t len;
+  uint8_t data[FRAME_MAX_PAYLOAD];
+};
+
+uint8_t frameCrc8(const uint8_t *p, uint8_t n, uint8_t crc = 0);
+
+// Writes a complete frame to out (len + FRAME_OVERHEAD bytes), returns its size.
+uint8_t frameEncode(uint8_t op, const uint8_t *payload, uint8_t len, uint8_t *out);
+
+// Byte-at-a-time receiver; feed() returns true when frame holds a valid frame.
+class FrameParser {
+ public:
+  Frame    frame;
+  uint16_t crcErrors = 0;
+  bool feed(uint8_t b);
+  void reset() { state = 0; }
+ private:
+  uint8_t state = 0, pos = 0, crc = 0;
+};
+
+// Pin strings ("0101...") packed into OP_PINS payloads and back.
+uint8_t packPinString(const char *bits, uint8_t n, uint8_t *payload);
+uint8_t unpackPinString(const uint8_t *payload, char *bits);
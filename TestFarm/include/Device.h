@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "Jobs.h"
+#include "Link.h"
+
+// One tester on the bench, driven through its text protocol.
+//
+// After the port opens the device is probed with LIST (repeated while an
+// Arduino is still in its bootloader); the answer gives the parts it knows
+// and its dialect:
+//   DIALECT_MEGA   ArduinoMegaTest: IC:<name> echoes the name, pin strings
+//                  carry the part's non-NC pins with pin 1 first.
+//   DIALECT_ESP14  Esp_test_1_Jun3: IC:<name> answers OK:IC_SELECTED, pin
+//                  strings are always 14 chars with pin 14 first.
+// A job then selects the part (IC:), applies each vector (PINS:), waits for
+// a pin report (PINS:/PD:) after OK:PINS_SET that shows the driven inputs
+// (the 1 s heartbeat when nothing changed), compares the outputs, and ends
+// with STATUS. Everything is event driven: onLine() for each received line,
+// onTimer() once deadline() has passed.
+
+enum Dialect : uint8_t { DIALECT_UNKNOWN, DIALECT_MEGA, DIALECT_ESP14 };
+enum DeviceState : uint8_t { DEV_PROBING, DEV_IDLE, DEV_BUSY, DEV_OFFLINE };
+
+#define PROBE_INTERVAL_MS 1000     // LIST again if nothing answered
+#define PROBE_TRIES       5
+#define LIST_QUIET_MS     150      // end of the LIST answer
+#define REPLY_TIMEOUT_MS  2000     // IC:, PINS:, STATUS answers
+#define SETTLE_TIMEOUT_MS 1500     // pin report after PINS: (heartbeat is 1 s)
+
+class Device {
+ public:
+  explicit Device(const std::string &path) : path(path) {}
+
+  bool open(uint64_t nowMs, std::string &err);
+  void start(Job &job, uint64_t nowMs);
+  void onLine(const std::string &line, uint64_t nowMs);
+  void onTimer(uint64_t nowMs);
+  void offline(const std::string &why, uint64_t nowMs);  // port gone; the job is handed back
+  uint64_t deadline() const { return deadline_; }
+
+  bool supports(const std::string &part) const { return parts.count(part) > 0; }
+  Job *takeFinished();                      // job that just ended, if any
+
+  std::string           path;
+  Link                  link;
+  Dialect               dialect = DIALECT_UNKNOWN;
+  DeviceState           state = DEV_PROBING;
+  std::set<std::string> parts;
+  std::string           lastError;
+  unsigned              jobsRun = 0;
+  uint64_t              busyMs = 0;
+
+ private:
+  enum Step : uint8_t { STEP_SELECT, STEP_PINS, STEP_SETTLE, STEP_STATUS };
+
+  void probe(uint64_t nowMs);
+  void nextVector(uint64_t nowMs);
+  void checkSettled(uint64_t nowMs);
+  void finish(JobResult r, const std::string &error, uint64_t nowMs);
+  void takeReport(const std::string &line);
+
+  Job                *job_ = nullptr, *done_ = nullptr;
+  Step                step_ = STEP_SELECT;
+  size_t              vector_ = 0;
+  std::vector<int>    order_;               // pin string position -> IC pin index
+  std::string         pins_;                // last reported pin string
+  uint64_t            deadline_ = 0;
+  bool                listing_ = false;
+  unsigned            probes_ = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test jobs, one per line of a jobs file:
+//
+//   <part>[*<copies>] [<vector> ...]      # comment
+//
+// A vector has one character per IC pin, pin 1 first:
+//   0 1  drive the input low/high      H L  expect the output high/low
+//   X    ignore (power pins, outputs nobody cares about)
+//   N    pin the tester does not carry (NC)
+// A job with no vectors only selects the part and reads STATUS back, which
+// checks that the tester knows the part and answers. <copies> queues the
+// same job several times, e.g. for a tray of the same chip.
+
+enum JobResult : uint8_t { JOB_PENDING, JOB_PASS, JOB_FAIL, JOB_ERROR };
+
+struct VectorFailure {
+  size_t      index;
+  std::string expected;        // the vector
+  std::string got;             // pin levels seen, '-' for pins not carried
+};
+
+struct Job {
+  size_t                     id = 0;
+  std::string                part;
+  std::vector<std::string>   vectors;
+  JobResult                  result = JOB_PENDING;
+  std::string                device, error;
+  std::vector<VectorFailure> failures;
+  uint64_t                   startMs = 0, endMs = 0;
+  uint8_t                    attempts = 0;
+  bool                       retry = false;   // lost to a tester fault, not to the part
+};
+
+bool loadJobs(const std::string &path, std::vector<Job> &jobs, std::string &err);
+const char *jobResultName(JobResult r);
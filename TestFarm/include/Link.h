@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// One end of a tester's serial line. Ports are opened raw at 115200 8N1 and
+// non-blocking; received bytes are split into lines ('\r' dropped) and sends
+// are queued and written out as the port takes them, so a slow or stuck
+// tester never blocks the event loop.
+class Link {
+ public:
+  ~Link() { close(); }
+
+  bool open(const std::string &path, std::string &err);
+  void attach(int fd);                      // already open fd (pty master)
+  void close();
+  int  fd() const { return fd_; }
+
+  // Appends every complete line that has arrived; false on hang-up or error.
+  bool receive(std::vector<std::string> &lines);
+  void send(const std::string &line);       // '\n' is appended
+  bool flush();                             // false on error
+  bool pending() const { return !out_.empty(); }
+
+ private:
+  int fd_ = -1;
+  std::string in_, out_;
+};
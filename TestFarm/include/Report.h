@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Device.h"
+#include "Jobs.h"
+
+// The aggregate JSON report of a run:
+//   {"summary": {jobs, passed, failed, errors, wallMs, jobsPerSecond},
+//    "devices": [{path, dialect, state, parts, jobs, busyMs, utilization, error}],
+//    "jobs":    [{id, part, device, result, attempts, ms, vectors, error,
+//                 failures: [{vector, expected, got}]}]}
+// written to path, or to stdout for "-".
+bool writeReport(const std::string &path, const std::vector<Job> &jobs,
+                 const std::vector<std::unique_ptr<Device>> &devices,
+                 uint64_t wallMs, std::string &err);
@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "Device.h"
+#include "Link.h"
+
+// A tester simulated behind a pseudo-terminal, for running the farm on a
+// machine with no hardware attached. The daemon opens slavePath() like any
+// serial port; the simulator answers IC:, PINS:, STATUS and LIST on the
+// master side in the chosen dialect and reports pin changes the way the
+// firmware does (a full PINS line after IC:, PD deltas after PINS:, a full
+// line in place of the heartbeat when PINS: changed nothing). It
+// knows the 14-pin 74xx gate packages, and an output can be made to stick
+// at a level to see the farm catch a bad part.
+
+class SimTester {
+ public:
+  explicit SimTester(Dialect d) : dialect_(d) {}
+  ~SimTester();
+
+  bool open(std::string &err);
+  const std::string &slavePath() const { return slavePath_; }
+  int  fd() const { return link_.fd(); }
+  Link &link() { return link_; }
+
+  void service();                              // answer what has arrived
+  void stickPin(uint8_t pin, bool level);      // IC pin 1-14
+
+ private:
+  void command(const std::string &cmd);
+  void evaluate();
+  std::string pinString() const;
+  uint16_t pinWord() const;
+
+  Dialect     dialect_;
+  Link        link_;
+  int         slaveFd_ = -1;                   // held open so the master never sees a hang-up
+  std::string slavePath_;
+  int         part_ = -1;
+  uint16_t    levels_ = 0;                     // bit p = IC pin p+1
+  uint16_t    stuckMask_ = 0, stuckValue_ = 0;
+  uint32_t    ms_ = 0;
+};
@@ -0,0 +1,195 @@
+#include "Device.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool startsWith(const std::string &s, const char *prefix) {
+  return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+bool Device::open(uint64_t nowMs, std::string &err) {
+  if (!link.open(path, err)) {
+    state = DEV_OFFLINE;
+    lastError = err;
+    return false;
+  }
+  state = DEV_PROBING;
+  probes_ = 0;
+  probe(nowMs);
+  return true;
+}
+
+void Device::probe(uint64_t nowMs) {
+  probes_++;
+  listing_ = false;
+  link.send("LIST");
+  deadline_ = nowMs + PROBE_INTERVAL_MS;
+}
+
+void Device::start(Job &job, uint64_t nowMs) {
+  job_ = &job;
+  job.device = path;
+  job.startMs = nowMs;
+  job.attempts++;
+  job.retry = false;
+  job.failures.clear();
+  job.error.clear();
+  state = DEV_BUSY;
+  vector_ = 0;
+  order_.clear();
+  const std::string *v = job.vectors.empty() ? nullptr : &job.vectors[0];
+  if (v && dialect == DIALECT_ESP14) {
+    if (v->size() != 14) { finish(JOB_ERROR, "14-pin tester, vectors have " + std::to_string(v->size()) + " pins", nowMs); return; }
+    for (int j = 0; j < 14; j++) order_.push_back(13 - j);
+  } else if (v) {
+    for (size_t p = 0; p < v->size(); p++)
+      if ((*v)[p] != 'N') order_.push_back(p);
+  }
+  pins_.clear();
+  step_ = STEP_SELECT;
+  link.send("IC:" + job.part);
+  deadline_ = nowMs + REPLY_TIMEOUT_MS;
+}
+
+void Device::nextVector(uint64_t nowMs) {
+  if (vector_ == job_->vectors.size()) {
+    step_ = STEP_STATUS;
+    link.send("STATUS");
+    deadline_ = nowMs + REPLY_TIMEOUT_MS;
+    return;
+  }
+  const std::string &v = job_->vectors[vector_];
+  std::string bits;
+  for (int p : order_) bits += v[p] == '1' ? '1' : '0';
+  step_ = STEP_PINS;
+  link.send("PINS:" + bits);
+  deadline_ = nowMs + REPLY_TIMEOUT_MS;
+}
+
+// The first report after OK:PINS_SET that shows every driven input at its
+// level also shows what the outputs made of them.
+void Device::checkSettled(uint64_t nowMs) {
+  if (pins_.size() != order_.size()) return;
+  const std::string &v = job_->vectors[vector_];
+  for (size_t j = 0; j < order_.size(); j++) {
+    char c = v[order_[j]];
+    if ((c == '0' || c == '1') && pins_[j] != c) return;
+  }
+  bool ok = true;
+  std::string got(v.size(), '-');
+  for (size_t j = 0; j < order_.size(); j++) {
+    char c = v[order_[j]];
+    got[order_[j]] = pins_[j];
+    if ((c == 'H' && pins_[j] != '1') || (c == 'L' && pins_[j] != '0')) ok = false;
+  }
+  if (!ok) job_->failures.push_back({vector_, v, got});
+  vector_++;
+  nextVector(nowMs);
+}
+
+// PINS:<bits> replaces the pin string; PD:<ms>:<changed>:<value> patches
+// it, bit j of the hex words being character j.
+void Device::takeReport(const std::string &line) {
+  if (startsWith(line, "PINS:")) {
+    pins_ = line.substr(5);
+    return;
+  }
+  size_t v = line.rfind(':');
+  if (pins_.empty() || v < 3) return;
+  unsigned long word = strtoul(line.c_str() + v + 1, nullptr, 16);
+  for (size_t j = 0; j < pins_.size(); j++) pins_[j] = (word >> j) & 1 ? '1' : '0';
+}
+
+void Device::onLine(const std::string &line, uint64_t nowMs) {
+  bool report = startsWith(line, "PINS:") || startsWith(line, "PD:");
+  if (report) takeReport(line);
+
+  if (state == DEV_PROBING) {
+    if (line == "AVAILABLE_ICS:") {
+      listing_ = true;
+      parts.clear();
+      deadline_ = nowMs + LIST_QUIET_MS;
+    } else if (listing_ && line.find(':') == std::string::npos) {
+      // "7400 (14 pins)" from the Mega, a bare name from the ESP32 tester
+      size_t paren = line.find(" (");
+      dialect = paren != std::string::npos ? DIALECT_MEGA : DIALECT_ESP14;
+      parts.insert(line.substr(0, paren));
+      deadline_ = nowMs + LIST_QUIET_MS;
+    }
+    return;
+  }
+  if (state != DEV_BUSY) return;
+
+  if (startsWith(line, "ERR")) {             // ERR:... and "ERROR: IC not found"
+    finish(JOB_ERROR, line, nowMs);
+    return;
+  }
+  switch (step_) {
+    case STEP_SELECT:
+      if (line == "IC:" + job_->part || line == "OK:IC_SELECTED") nextVector(nowMs);
+      break;
+    case STEP_PINS:
+      // Reports before the acknowledgement may predate the new vector.
+      if (line != "OK:PINS_SET") break;
+      step_ = STEP_SETTLE;
+      deadline_ = nowMs + SETTLE_TIMEOUT_MS;
+      break;
+    case STEP_SETTLE:
+      if (report) checkSettled(nowMs);
+      break;
+    case STEP_STATUS:
+      if (line == "STATUS:NO_IC") finish(JOB_ERROR, "part was deselected", nowMs);
+      else if (startsWith(line, "STATUS:")) finish(job_->failures.empty() ? JOB_PASS : JOB_FAIL, "", nowMs);
+      break;
+  }
+}
+
+void Device::onTimer(uint64_t nowMs) {
+  if (!deadline_ || nowMs < deadline_) return;
+  if (state == DEV_PROBING) {
+    if (listing_ && !parts.empty()) {
+      state = DEV_IDLE;
+      deadline_ = 0;
+    } else if (probes_ >= PROBE_TRIES) {
+      offline("no answer to LIST", nowMs);
+    } else {
+      probe(nowMs);
+    }
+  } else if (state == DEV_BUSY) {
+    static const char *const waitingFor[] = {"IC", "OK:PINS_SET", "pin report", "STATUS"};
+    job_->retry = true;
+    finish(JOB_ERROR, std::string("timeout waiting for ") + waitingFor[step_], nowMs);
+    // Whatever went wrong, find out whether the tester is still there.
+    state = DEV_PROBING;
+    probes_ = 0;
+    probe(nowMs);
+  }
+}
+
+void Device::offline(const std::string &why, uint64_t nowMs) {
+  if (job_) {
+    job_->retry = true;
+    finish(JOB_ERROR, why, nowMs);
+  }
+  state = DEV_OFFLINE;
+  lastError = why;
+  deadline_ = 0;
+  link.close();
+}
+
+void Device::finish(JobResult r, const std::string &error, uint64_t nowMs) {
+  job_->result = r;
+  job_->error = error;
+  job_->endMs = nowMs;
+  busyMs += nowMs - job_->startMs;
+  jobsRun++;
+  done_ = job_;
+  job_ = nullptr;
+  state = DEV_IDLE;
+  deadline_ = 0;
+}
+
+Job *Device::takeFinished() {
+  Job *j = done_;
+  done_ = nullptr;
+  return j;
+}
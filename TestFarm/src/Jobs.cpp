@@ -0,0 +1,58 @@
+#include "Jobs.h"
+#include <ctype.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+static bool validVector(const std::string &v) {
+  for (char c : v)
+    if (!strchr("01HLXN", c)) return false;
+  return !v.empty();
+}
+
+bool loadJobs(const std::string &path, std::vector<Job> &jobs, std::string &err) {
+  std::ifstream in(path);
+  if (!in) { err = path + ": cannot open"; return false; }
+  std::string line;
+  for (int lineNo = 1; std::getline(in, line); lineNo++) {
+    size_t hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    std::istringstream words(line);
+    std::string head;
+    if (!(words >> head)) continue;
+    Job job;
+    unsigned long copies = 1;
+    size_t star = head.find('*');
+    if (star != std::string::npos) {
+      copies = strtoul(head.c_str() + star + 1, nullptr, 10);
+      head.erase(star);
+    }
+    job.part = head;
+    for (std::string v; words >> v;) {
+      for (char &c : v) c = toupper(c);
+      if (!validVector(v) || (!job.vectors.empty() && v.size() != job.vectors[0].size())) {
+        err = path + ":" + std::to_string(lineNo) + ": bad vector " + v;
+        return false;
+      }
+      job.vectors.push_back(v);
+    }
+    if (job.part.empty() || !copies) {
+      err = path + ":" + std::to_string(lineNo) + ": bad job";
+      return false;
+    }
+    while (copies--) {
+      job.id = jobs.size();
+      jobs.push_back(job);
+    }
+  }
+  return true;
+}
+
+const char *jobResultName(JobResult r) {
+  switch (r) {
+    case JOB_PASS:  return "PASS";
+    case JOB_FAIL:  return "FAIL";
+    case JOB_ERROR: return "ERROR";
+    default:        return "PENDING";
+  }
+}
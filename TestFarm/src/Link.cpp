@@ -0,0 +1,79 @@
+#include "Link.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define LINE_MAX_BYTES 512     // longer lines are garbage, not protocol
+
+bool Link::open(const std::string &path, std::string &err) {
+  close();
+  int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) { err = strerror(errno); return false; }
+  struct termios t;
+  if (tcgetattr(fd, &t) == 0) {
+    cfmakeraw(&t);
+    cfsetispeed(&t, B115200);
+    cfsetospeed(&t, B115200);
+    t.c_cflag |= CLOCAL | CREAD;
+    t.c_cflag &= ~CRTSCTS;
+    tcsetattr(fd, TCSANOW, &t);
+    tcflush(fd, TCIOFLUSH);
+  }
+  attach(fd);
+  return true;
+}
+
+void Link::attach(int fd) {
+  close();
+  fd_ = fd;
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+}
+
+void Link::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  in_.clear();
+  out_.clear();
+}
+
+bool Link::receive(std::vector<std::string> &lines) {
+  char buf[512];
+  for (;;) {
+    ssize_t n = read(fd_, buf, sizeof(buf));
+    if (n > 0) {
+      for (ssize_t i = 0; i < n; i++) {
+        char c = buf[i];
+        if (c == '\r') continue;
+        if (c != '\n') {
+          if (in_.size() < LINE_MAX_BYTES) in_ += c;
+          continue;
+        }
+        if (!in_.empty()) lines.push_back(in_);
+        in_.clear();
+      }
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (n < 0 && errno == EINTR) continue;
+    return false;                         // EOF (hang-up) or error
+  }
+}
+
+void Link::send(const std::string &line) {
+  out_ += line;
+  out_ += '\n';
+  flush();
+}
+
+bool Link::flush() {
+  while (!out_.empty()) {
+    ssize_t n = write(fd_, out_.data(), out_.size());
+    if (n > 0) { out_.erase(0, n); continue; }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (n < 0 && errno == EINTR) continue;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,87 @@
+#include "Report.h"
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+static std::string quote(const std::string &s) {
+  std::string q = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') { q += '\\'; q += c; }
+    else if ((unsigned char)c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      q += buf;
+    } else {
+      q += c;
+    }
+  }
+  return q + "\"";
+}
+
+static const char *dialectName(Dialect d) {
+  switch (d) {
+    case DIALECT_MEGA:  return "mega";
+    case DIALECT_ESP14: return "esp14";
+    default:            return "unknown";
+  }
+}
+
+static const char *stateName(DeviceState s) {
+  switch (s) {
+    case DEV_PROBING: return "probing";
+    case DEV_IDLE:    return "idle";
+    case DEV_BUSY:    return "busy";
+    default:          return "offline";
+  }
+}
+
+bool writeReport(const std::string &path, const std::vector<Job> &jobs,
+                 const std::vector<std::unique_ptr<Device>> &devices,
+                 uint64_t wallMs, std::string &err) {
+  unsigned count[4] = {0, 0, 0, 0};
+  for (const Job &j : jobs) count[j.result]++;
+  std::ostringstream o;
+  o << "{\n  \"summary\": {\"jobs\": " << jobs.size()
+    << ", \"passed\": " << count[JOB_PASS] << ", \"failed\": " << count[JOB_FAIL]
+    << ", \"errors\": " << count[JOB_ERROR] + count[JOB_PENDING] << ", \"wallMs\": " << wallMs
+    << ", \"jobsPerSecond\": " << (wallMs ? jobs.size() * 1000.0 / wallMs : 0.0) << "},\n";
+
+  o << "  \"devices\": [";
+  for (size_t i = 0; i < devices.size(); i++) {
+    const Device &d = *devices[i];
+    o << (i ? ",\n" : "\n") << "    {\"path\": " << quote(d.path)
+      << ", \"dialect\": \"" << dialectName(d.dialect) << "\", \"state\": \"" << stateName(d.state)
+      << "\", \"parts\": " << d.parts.size() << ", \"jobs\": " << d.jobsRun
+      << ", \"busyMs\": " << d.busyMs << ", \"utilization\": " << (wallMs ? (double)d.busyMs / wallMs : 0.0);
+    if (!d.lastError.empty()) o << ", \"error\": " << quote(d.lastError);
+    o << "}";
+  }
+  o << "\n  ],\n  \"jobs\": [";
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const Job &j = jobs[i];
+    o << (i ? ",\n" : "\n") << "    {\"id\": " << j.id << ", \"part\": " << quote(j.part)
+      << ", \"device\": " << quote(j.device) << ", \"result\": \"" << jobResultName(j.result)
+      << "\", \"attempts\": " << (unsigned)j.attempts << ", \"ms\": " << (j.endMs - j.startMs)
+      << ", \"vectors\": " << j.vectors.size();
+    if (!j.error.empty()) o << ", \"error\": " << quote(j.error);
+    if (!j.failures.empty()) {
+      o << ", \"failures\": [";
+      for (size_t f = 0; f < j.failures.size(); f++) {
+        const VectorFailure &v = j.failures[f];
+        o << (f ? ", " : "") << "{\"vector\": " << v.index << ", \"expected\": " << quote(v.expected)
+          << ", \"got\": " << quote(v.got) << "}";
+      }
+      o << "]";
+    }
+    o << "}";
+  }
+  o << "\n  ]\n}\n";
+
+  if (path == "-") {
+    fputs(o.str().c_str(), stdout);
+    return true;
+  }
+  std::ofstream out(path);
+  if (!(out << o.str())) { err = path + ": cannot write"; return false; }
+  return true;
+}
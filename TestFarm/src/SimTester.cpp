@@ -0,0 +1,171 @@
+#include "SimTester.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+struct SimGate { uint8_t y, a, b; };         // IC pins, b = 0 for an inverter
+
+struct SimPart {
+  const char *name;
+  char        op;                            // & | ^ n(and) o(nor) ~
+  uint8_t     gates;
+  SimGate     gate[6];
+};
+
+#define QUAD_2IN {{3, 1, 2}, {6, 4, 5}, {8, 9, 10}, {11, 12, 13}}
+
+static const SimPart SIM_PARTS[] = {
+  {"7400", 'n', 4, QUAD_2IN},
+  {"7402", 'o', 4, {{1, 2, 3}, {4, 5, 6}, {10, 8, 9}, {13, 11, 12}}},
+  {"7404", '~', 6, {{2, 1, 0}, {4, 3, 0}, {6, 5, 0}, {8, 9, 0}, {10, 11, 0}, {12, 13, 0}}},
+  {"7408", '&', 4, QUAD_2IN},
+  {"7432", '|', 4, QUAD_2IN},
+  {"7486", '^', 4, QUAD_2IN},
+};
+#define SIM_PART_COUNT (sizeof(SIM_PARTS) / sizeof(SIM_PARTS[0]))
+#define SIM_PINS 14
+#define SIM_VCC  (1u << 13)
+
+static uint16_t inputMask(const SimPart &p) {
+  uint16_t m = 0;
+  for (uint8_t g = 0; g < p.gates; g++) {
+    m |= 1u << (p.gate[g].a - 1);
+    if (p.gate[g].b) m |= 1u << (p.gate[g].b - 1);
+  }
+  return m;
+}
+
+static uint32_t nowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+SimTester::~SimTester() {
+  if (slaveFd_ >= 0) close(slaveFd_);
+}
+
+bool SimTester::open(std::string &err) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    err = std::string("pty: ") + strerror(errno);
+    if (master >= 0) close(master);
+    return false;
+  }
+  slavePath_ = ptsname(master);
+  slaveFd_ = ::open(slavePath_.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (slaveFd_ < 0) {
+    err = slavePath_ + ": " + strerror(errno);
+    close(master);
+    return false;
+  }
+  struct termios t;
+  tcgetattr(slaveFd_, &t);
+  cfmakeraw(&t);
+  tcsetattr(slaveFd_, TCSANOW, &t);
+  link_.attach(master);
+  return true;
+}
+
+void SimTester::stickPin(uint8_t pin, bool level) {
+  stuckMask_ |= 1u << (pin - 1);
+  if (level) stuckValue_ |= 1u << (pin - 1);
+  else stuckValue_ &= ~(1u << (pin - 1));
+}
+
+void SimTester::evaluate() {
+  const SimPart &p = SIM_PARTS[part_];
+  for (uint8_t g = 0; g < p.gates; g++) {
+    const SimGate &s = p.gate[g];
+    bool a = levels_ >> (s.a - 1) & 1, b = s.b && (levels_ >> (s.b - 1) & 1), y;
+    switch (p.op) {
+      case '&': y = a && b; break;
+      case '|': y = a || b; break;
+      case '^': y = a != b; break;
+      case 'n': y = !(a && b); break;
+      case 'o': y = !(a || b); break;
+      default:  y = !a; break;
+    }
+    levels_ = (levels_ & ~(1u << (s.y - 1))) | (uint16_t)y << (s.y - 1);
+  }
+  levels_ = (levels_ & ~stuckMask_) | stuckValue_;
+}
+
+// Pin string bits as the dialect numbers them.
+uint16_t SimTester::pinWord() const {
+  if (dialect_ == DIALECT_MEGA) return levels_;
+  uint16_t w = 0;
+  for (int j = 0; j < SIM_PINS; j++)
+    if (levels_ & (1u << (SIM_PINS - 1 - j))) w |= 1u << j;
+  return w;
+}
+
+std::string SimTester::pinString() const {
+  uint16_t w = pinWord();
+  std::string s;
+  for (int j = 0; j < SIM_PINS; j++) s += w & (1u << j) ? '1' : '0';
+  return s;
+}
+
+void SimTester::service() {
+  std::vector<std::string> lines;
+  link_.receive(lines);
+  for (const std::string &l : lines) command(l);
+}
+
+void SimTester::command(const std::string &cmd) {
+  bool mega = dialect_ == DIALECT_MEGA;
+  if (cmd == "LIST") {
+    link_.send("AVAILABLE_ICS:");
+    for (const SimPart &p : SIM_PARTS) link_.send(mega ? std::string(p.name) + " (14 pins)" : p.name);
+  } else if (cmd.compare(0, 3, "IC:") == 0) {
+    std::string name = cmd.substr(3);
+    part_ = -1;
+    for (size_t i = 0; i < SIM_PART_COUNT; i++)
+      if (name == SIM_PARTS[i].name) part_ = i;
+    if (part_ < 0) {
+      link_.send(mega ? "ERROR: IC not found - " + name : "ERR:IC_NOT_FOUND");
+      return;
+    }
+    levels_ = SIM_VCC;
+    evaluate();
+    if (mega) {
+      link_.send("INFO:Configured " + name + " (14 pins)");
+      link_.send("IC:" + name);
+    } else {
+      link_.send("OK:IC_SELECTED");
+    }
+    link_.send("PINS:" + pinString());
+  } else if (cmd.compare(0, 5, "PINS:") == 0) {
+    std::string bits = cmd.substr(5);
+    if (part_ < 0) { link_.send("ERR:NO_IC_SELECTED"); return; }
+    if (bits.size() != SIM_PINS) { link_.send("ERR:INVALID_PIN_LENGTH"); return; }
+    uint16_t before = pinWord(), in = inputMask(SIM_PARTS[part_]);
+    for (int j = 0; j < SIM_PINS; j++) {
+      int pin = mega ? j : SIM_PINS - 1 - j;
+      if (!(in & (1u << pin))) continue;
+      if (bits[j] == '1') levels_ |= 1u << pin;
+      else levels_ &= ~(1u << pin);
+    }
+    evaluate();
+    link_.send("OK:PINS_SET");
+    uint16_t after = pinWord();
+    // Nothing changed: the firmware's next report would be its heartbeat,
+    // which the simulator, having no timer, sends right away.
+    if (after == before) { link_.send("PINS:" + pinString()); return; }
+    char buf[48];
+    snprintf(buf, sizeof(buf), "PD:%u:%X:%X", nowMs(), before ^ after, after);
+    link_.send(buf);
+  } else if (cmd == "STATUS") {
+    if (part_ < 0) { if (!mega) link_.send("STATUS:NO_IC"); return; }
+    const SimPart &p = SIM_PARTS[part_];
+    if (mega) link_.send(std::string("STATUS:IC:") + p.name + " Pins:14 Gates:" + std::to_string(p.gates));
+    else link_.send(std::string("STATUS:IC=") + p.name + ",INPUTS=" + std::to_string(__builtin_popcount(inputMask(p))));
+  } else {
+    link_.send("ERR:INVALID_CMD");
+  }
+}
@@ -0,0 +1,204 @@
+// Test farm: runs a queue of IC test jobs across every tester on the bench.
+//
+//   program --jobs FILE [--report FILE|-] [--sim N] [--sim-fault S:PIN:LEVEL] [PORT ...]
+//
+// Each PORT (e.g. /dev/ttyACM0) is a tester running ArduinoMegaTest or
+// Esp_test_1_Jun3. --sim N adds N simulated testers on pseudo-terminals,
+// alternating Mega and ESP32 dialects; --sim-fault sticks IC pin PIN of
+// simulated tester S (from 0) at LEVEL. All ports are multiplexed with
+// epoll on one thread: a tester that is free takes the first queued job
+// for a part it knows, so the bench works through the queue in parallel.
+// Jobs lost to a tester fault (timeout, unplugged) are queued again once.
+// Progress goes to stderr, the JSON report (see Report.h) to --report,
+// default testfarm-report.json. Exits 0 if every job passed.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "Device.h"
+#include "Jobs.h"
+#include "Report.h"
+#include "SimTester.h"
+
+#define MAX_ATTEMPTS 2
+#define MAX_EVENTS   32
+
+enum Endpoint : uint64_t { EP_DEVICE = 0, EP_SIM = 1ULL << 32 };
+
+static uint64_t nowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Keeps EPOLLOUT armed only while a link has output queued.
+struct Watch {
+  int      ep;
+  Link    *link;
+  uint64_t tag;
+  bool     out;
+};
+
+static bool watchAdd(Watch &w) {
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = w.tag;
+  w.out = false;
+  return epoll_ctl(w.ep, EPOLL_CTL_ADD, w.link->fd(), &ev) == 0;
+}
+
+static void watchUpdate(Watch &w) {
+  if (w.link->fd() < 0 || w.link->pending() == w.out) return;
+  struct epoll_event ev = {};
+  w.out = w.link->pending();
+  ev.events = EPOLLIN;
+  if (w.out) ev.events |= EPOLLOUT;
+  ev.data.u64 = w.tag;
+  epoll_ctl(w.ep, EPOLL_CTL_MOD, w.link->fd(), &ev);
+}
+
+static int usage(const char *argv0) {
+  fprintf(stderr, "usage: %s --jobs FILE [--report FILE|-] [--sim N] [--sim-fault S:PIN:LEVEL] [PORT ...]\n", argv0);
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  std::string jobsPath, reportPath = "testfarm-report.json";
+  std::vector<std::string> ports;
+  std::vector<std::unique_ptr<SimTester>> sims;
+  std::vector<std::string> faults;
+  unsigned simCount = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--jobs") && i + 1 < argc) jobsPath = argv[++i];
+    else if (!strcmp(argv[i], "--report") && i + 1 < argc) reportPath = argv[++i];
+    else if (!strcmp(argv[i], "--sim") && i + 1 < argc) simCount = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--sim-fault") && i + 1 < argc) faults.push_back(argv[++i]);
+    else if (argv[i][0] == '-') return usage(argv[0]);
+    else ports.push_back(argv[i]);
+  }
+  if (jobsPath.empty() || (ports.empty() && !simCount)) return usage(argv[0]);
+
+  std::vector<Job> jobs;
+  std::string err;
+  if (!loadJobs(jobsPath, jobs, err)) { fprintf(stderr, "%s\n", err.c_str()); return 2; }
+
+  for (unsigned i = 0; i < simCount; i++) {
+    sims.emplace_back(new SimTester(i & 1 ? DIALECT_ESP14 : DIALECT_MEGA));
+    if (!sims.back()->open(err)) { fprintf(stderr, "sim %u: %s\n", i, err.c_str()); return 1; }
+    ports.push_back(sims.back()->slavePath());
+  }
+  for (const std::string &f : faults) {
+    unsigned s, pin, level;
+    if (sscanf(f.c_str(), "%u:%u:%u", &s, &pin, &level) != 3 || s >= sims.size() || pin < 1 || pin > 14)
+      return usage(argv[0]);
+    sims[s]->stickPin(pin, level);
+  }
+
+  int ep = epoll_create1(EPOLL_CLOEXEC);
+  if (ep < 0) { perror("epoll_create1"); return 1; }
+  uint64_t t0 = nowMs();
+  std::vector<std::unique_ptr<Device>> devices;
+  std::vector<Watch> watches;
+  for (size_t i = 0; i < ports.size(); i++) {
+    devices.emplace_back(new Device(ports[i]));
+    if (!devices.back()->open(t0, err)) { fprintf(stderr, "%s: %s\n", ports[i].c_str(), err.c_str()); continue; }
+    watches.push_back({ep, &devices.back()->link, EP_DEVICE | i, false});
+  }
+  for (size_t i = 0; i < sims.size(); i++) watches.push_back({ep, &sims[i]->link(), EP_SIM | i, false});
+  for (Watch &w : watches) watchAdd(w);
+
+  std::deque<Job *> queue;
+  for (Job &j : jobs) queue.push_back(&j);
+  std::vector<std::string> lines;
+  struct epoll_event events[MAX_EVENTS];
+
+  for (;;) {
+    uint64_t now = nowMs();
+
+    // Collect finished jobs, then hand out queued ones to free testers.
+    bool probing = false, busy = false, online = false;
+    for (auto &d : devices) {
+      if (Job *j = d->takeFinished()) {
+        fprintf(stderr, "%s %s %s %zu vectors %llu ms%s%s\n", d->path.c_str(), j->part.c_str(),
+                jobResultName(j->result), j->vectors.size(), (unsigned long long)(j->endMs - j->startMs),
+                j->error.empty() ? "" : " - ", j->error.c_str());
+        if (j->result == JOB_ERROR && j->retry && j->attempts < MAX_ATTEMPTS) {
+          j->result = JOB_PENDING;
+          queue.push_front(j);
+        }
+      }
+      if (d->state == DEV_IDLE) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+          if (!d->supports((*it)->part)) continue;
+          Job *j = *it;
+          queue.erase(it);
+          d->start(*j, now);
+          break;
+        }
+      }
+      probing |= d->state == DEV_PROBING;
+      busy |= d->state == DEV_BUSY;
+      online |= d->state != DEV_OFFLINE;
+    }
+    // Once every tester has said what it knows, jobs nobody can run fail.
+    if (!probing) {
+      for (auto it = queue.begin(); it != queue.end();) {
+        bool known = false;
+        for (auto &d : devices) known |= d->state != DEV_OFFLINE && d->supports((*it)->part);
+        if (known) { ++it; continue; }
+        (*it)->result = JOB_ERROR;
+        (*it)->error = online ? "no tester knows this part" : "no tester online";
+        fprintf(stderr, "%s ERROR - %s\n", (*it)->part.c_str(), (*it)->error.c_str());
+        it = queue.erase(it);
+      }
+      if (queue.empty() && !busy) break;
+    }
+
+    for (Watch &w : watches) watchUpdate(w);
+    uint64_t wake = 0;
+    for (auto &d : devices)
+      if (d->deadline() && (!wake || d->deadline() < wake)) wake = d->deadline();
+    int timeout = !wake ? -1 : wake <= now ? 0 : (int)(wake - now);
+    int n = epoll_wait(ep, events, MAX_EVENTS, timeout);
+    if (n < 0 && errno != EINTR) { perror("epoll_wait"); return 1; }
+    now = nowMs();
+
+    for (int e = 0; e < n; e++) {
+      uint64_t tag = events[e].data.u64;
+      size_t idx = tag & 0xFFFFFFFF;
+      if (tag & EP_SIM) {
+        SimTester &s = *sims[idx];
+        if (events[e].events & EPOLLIN) s.service();
+        if (events[e].events & EPOLLOUT) s.link().flush();
+        continue;
+      }
+      Device &d = *devices[idx];
+      if (d.state == DEV_OFFLINE) continue;
+      bool ok = true;
+      if (events[e].events & EPOLLOUT) ok = d.link.flush();
+      if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        lines.clear();
+        ok = d.link.receive(lines) && ok;
+        for (const std::string &l : lines) d.onLine(l, now);
+      }
+      if (!ok) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, d.link.fd(), nullptr);
+        d.offline("port closed", now);
+      }
+    }
+    for (auto &d : devices) d.get()->onTimer(now);
+  }
+
+  uint64_t wall = nowMs() - t0;
+  unsigned passed = 0;
+  for (const Job &j : jobs) passed += j.result == JOB_PASS;
+  fprintf(stderr, "%u/%zu jobs passed on %zu testers in %llu ms\n", passed, jobs.size(), devices.size(),
+          (unsigned long long)wall);
+  if (!writeReport(reportPath, jobs, devices, wall, err)) { fprintf(stderr, "%s\n", err.c_str()); return 1; }
+  return passed == jobs.size() ? 0 : 1;
+}
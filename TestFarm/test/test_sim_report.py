@@ -0,0 +1,108 @@
+"""End-to-end check of the farm against its simulated testers.
+
+Runs the built program with --sim on jobs/example.jobs, once on good testers
+and once with an IC pin stuck high, and checks the JSON report: the pass,
+fail and error counts, and for the faulty run exactly which vectors failed
+and what the tester read back.
+
+    pio run -e native && python3 test/test_sim_report.py [PROGRAM]
+
+PROGRAM defaults to .pio/build/native/program.
+"""
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+JOBS = os.path.join(ROOT, "jobs", "example.jobs")
+PROGRAM = os.path.join(ROOT, ".pio", "build", "native", "program")
+
+FAULT_PIN = 3
+
+
+def read_jobs(path):
+    """(part, copies, [vector]) per job line, as Jobs.h describes them."""
+    jobs = []
+    with open(path) as f:
+        for line in f:
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            part, _, copies = words[0].partition("*")
+            jobs.append((part, int(copies or 1), words[1:]))
+    return jobs
+
+
+def run_farm(jobs_path, *args):
+    proc = subprocess.run([PROGRAM, "--jobs", jobs_path, "--report", "-"] + list(args),
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True, timeout=60)
+    return proc.returncode, json.loads(proc.stdout)
+
+
+class SimReport(unittest.TestCase):
+    def test_good_testers_pass_every_job(self):
+        jobs = read_jobs(JOBS)
+        total = sum(copies for _, copies, _ in jobs)
+        code, report = run_farm(JOBS, "--sim", "4")
+        self.assertEqual(code, 0)
+        self.assertEqual(report["summary"]["jobs"], total)
+        self.assertEqual(report["summary"]["passed"], total)
+        self.assertEqual(report["summary"]["failed"], 0)
+        self.assertEqual(report["summary"]["errors"], 0)
+        self.assertEqual(len(report["devices"]), 4)
+        for job in report["jobs"]:
+            self.assertEqual(job["result"], "PASS", job)
+            self.assertNotIn("failures", job)
+
+    def test_stuck_output_fails_the_vectors_that_expect_low(self):
+        # Only parts with an output on the stuck pin: a stuck input is never
+        # reported back as driven and ends the job with a timeout instead.
+        # Each vector runs twice in a row, so a vector that changes no pin is
+        # graded too.
+        jobs = [(part, copies, [v for v in vectors for _ in (0, 1)])
+                for part, copies, vectors in read_jobs(JOBS)
+                if vectors and vectors[0][FAULT_PIN - 1] in "HL"]
+        self.assertTrue(jobs)
+        with tempfile.NamedTemporaryFile("w", suffix=".jobs", delete=False) as f:
+            for part, copies, vectors in jobs:
+                f.write("%s*%d  %s\n" % (part, copies, " ".join(vectors)))
+        try:
+            code, report = run_farm(f.name, "--sim", "1", "--sim-fault", "0:%d:1" % FAULT_PIN)
+        finally:
+            os.unlink(f.name)
+
+        total = sum(copies for _, copies, _ in jobs)
+        self.assertNotEqual(code, 0)
+        self.assertEqual(report["summary"]["jobs"], total)
+        self.assertEqual(report["summary"]["passed"], 0)
+        self.assertEqual(report["summary"]["failed"], total)
+        self.assertEqual(report["summary"]["errors"], 0)
+
+        expected = {part: vectors for part, _, vectors in jobs}
+        for job in report["jobs"]:
+            self.assertEqual(job["result"], "FAIL", job)
+            vectors = expected[job["part"]]
+            want = [i for i, v in enumerate(vectors) if v[FAULT_PIN - 1] == "L"]
+            self.assertEqual([f["vector"] for f in job["failures"]], want, job)
+            for failure in job["failures"]:
+                vector, got = vectors[failure["vector"]], failure["got"]
+                self.assertEqual(failure["expected"], vector)
+                self.assertEqual(len(got), len(vector))
+                for pin, (e, g) in enumerate(zip(vector, got), 1):
+                    if pin == FAULT_PIN:
+                        self.assertEqual(g, "1", failure)
+                    elif e in "HL":
+                        self.assertEqual(g, "1" if e == "H" else "0", failure)
+                    elif e in "01":
+                        self.assertEqual(g, e, failure)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) > 1 and not sys.argv[1].startswith("-"):
+        PROGRAM = os.path.abspath(sys.argv.pop(1))
+    unittest.main()